@@ -10,6 +10,9 @@ struct Transform
     vec2 pos{0.0f};
 };
 
+// Render-time interpolation between fixed steps
+Transform blend(const Transform& prev, const Transform& cur, float alpha) { return {glm::mix(prev.pos, cur.pos, alpha)}; }
+
 struct Velocity
 {
     vec2 vel{0.0f};
@@ -152,14 +155,14 @@ void pipe_scroll_system(ECS& ecs, float dt, float)
     }
 }
 
-void render_system(ECS& ecs, float, float)
+void render_system(ECS& ecs, float, float alpha)
 {
     auto& renderer = kine::renderer;
     auto view = ecs.view<Transform, Sprite>();
 
     for (auto e : view)
     {
-        auto& t = e.get<Transform>();
+        auto t = kine::interpolation::get<Transform>(e, alpha);
         auto& s = e.get<Sprite>();
 
         kine::render::draw_rect(t.pos, s.size, s.color);
@@ -215,6 +218,8 @@ int main()
     std::vector<Pipe*> pipes;
     tree->find_all<Pipe>(pipes);
 
+    kine::interpolation::track<Transform>();
+
     add_system("Physics", physics_system);
     add_system("Render", render_system);
     add_system("PipeScroll", pipe_scroll_system);
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "kine/kine.hpp"
+
+// Pyramids of boxes on a static floor. Run with --bench [threads] to step the
+// 10k body version headless and print step timings instead of opening a window.
+
+namespace physics = kine::physics;
+
+using kine::ECS;
+
+#define SCREEN_WIDTH 1280.0f
+#define SCREEN_HEIGHT 720.0f
+#define FLOOR_Y 680.0f
+
+struct Scene
+{
+    int pyramids = 5;
+    int base = 20;
+    float box = 10.f;
+};
+
+static void build_scene(ECS& ecs, const Scene& s)
+{
+    physics::BodyDef floor;
+    floor.type = physics::BodyType::Static;
+    floor.shape = physics::box({s.pyramids * s.base * s.box, 20.f});
+    floor.position = {0.5f * SCREEN_WIDTH, FLOOR_Y + 20.f};
+    physics::add_body(ecs.create(), floor);
+
+    physics::BodyDef def;
+    def.shape = physics::box(vec2(0.5f * s.box));
+
+    const float spacing = (s.base + 2) * s.box;
+    const float left = 0.5f * SCREEN_WIDTH - 0.5f * spacing * float(s.pyramids - 1);
+    for (int p = 0; p < s.pyramids; ++p)
+    {
+        for (int row = 0; row < s.base; ++row)
+        {
+            for (int col = 0; col < s.base - row; ++col)
+            {
+                const float x = left + p * spacing + (col - 0.5f * float(s.base - row - 1)) * s.box;
+                def.position = {x, FLOOR_Y - (row + 0.5f) * s.box};
+                physics::add_body(ecs.create(), def);
+            }
+        }
+    }
+}
+
+static double percentile(std::vector<double> v, double p)
+{
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, std::size_t(p * double(v.size())))];
+}
+
+static int bench(unsigned threads)
+{
+    ECS ecs;
+    physics::Config config;
+    config.worker_threads = threads;
+    physics::World& world = physics::create_world(ecs, config);
+
+    // 48 pyramids of 210 boxes
+    build_scene(ecs, {48, 20, 8.f});
+
+    const float dt = 1.f / 60.f;
+    std::vector<double> step_ms;
+    for (int n = 0; n < 600; ++n)
+    {
+        physics::step(ecs, dt);
+        step_ms.push_back(double(world.stats.step_ns) * 1e-6);
+
+        if (n % 60 == 0)
+            LOG_INFO("step {}: {} bodies, {} awake, {} contacts, {} islands, {} asleep, {:.2f} ms", n,
+                     world.stats.bodies, world.stats.awake, world.stats.contacts, world.stats.islands,
+                     world.stats.sleeping_islands, step_ms.back());
+    }
+
+    // Settled pyramids sleep, so the first second is the interesting part
+    const std::vector<double> first(step_ms.begin(), step_ms.begin() + 60);
+    LOG_INFO("Awake steps: p50 {:.2f} ms, p99 {:.2f} ms", percentile(first, 0.5), percentile(first, 0.99));
+    LOG_INFO("All steps: p50 {:.2f} ms, p99 {:.2f} ms", percentile(step_ms, 0.5), percentile(step_ms, 0.99));
+    return 0;
+}
+
+void render_system(ECS& ecs, float, float alpha)
+{
+    physics::World* world = physics::get_world(ecs);
+
+    for (auto e : ecs.view<physics::Body, physics::Pose>())
+    {
+        const physics::BodyId id = e.get<physics::Body>().id;
+        const physics::Shape& shape = world->bodies.shape[id.index];
+        const physics::Pose pose = kine::interpolation::get<physics::Pose>(e, alpha);
+
+        const bool awake = physics::is_awake(world, id);
+        const std::array<float, 4> color = awake ? std::array<float, 4>{230, 180, 60, 255}
+                                                 : std::array<float, 4>{110, 110, 140, 255};
+
+        if (shape.type == physics::ShapeType::Circle)
+        {
+            kine::render::draw_circle(pose.position, shape.radius, color);
+            continue;
+        }
+
+        // A box is a line as thick as the box is tall, one quad per body
+        const vec2 half = shape.vertices[2];
+        const vec2 axis = physics::rotate(physics::rotation(pose.angle), {half.x, 0.f});
+        kine::render::draw_line(pose.position - axis, pose.position + axis, half.y, color);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0)
+        return bench(argc > 2 ? unsigned(std::atoi(argv[2])) : 0);
+
+    kine::create(SCREEN_WIDTH, SCREEN_HEIGHT, "Kine - Physics Stack");
+    auto& ecs = kine::flow_tree->ecs;
+    kine::flow_tree->finalize();
+
+    physics::create_world(ecs);
+    build_scene(ecs, {});
+
+    kine::interpolation::track<physics::Pose>();
+    kine::scheduler::add_system("Render", render_system);
+
+    kine::init();
+    while (kine::running)
+    {
+        kine::begin_frame();
+
+        // Click to drop a ball in
+        if (kine::input::mouse_pressed(&kine::global_input, GLFW_MOUSE_BUTTON_LEFT))
+        {
+            physics::BodyDef ball;
+            ball.shape = physics::circle(12.f);
+            ball.position = kine::input::mouse_position(&kine::global_input);
+            ball.density = 4.f;
+            physics::add_body(ecs.create(), ball);
+        }
+
+        kine::update();
+        kine::render_frame();
+    }
+
+    kine::shutdown();
+    return 0;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kine/resources/resource_pool.hpp"
+
+namespace kine
+{
+
+// Fully decoded sound: interleaved stereo f32 at audio::config.sample_rate
+struct Sound
+{
+    std::vector<float> samples;
+    std::uint64_t frames = 0;
+};
+
+using SoundHandle = Handle<Sound>;
+
+namespace audio
+{
+    inline constexpr std::size_t MAX_VOICES = 64;
+    inline constexpr std::size_t COMMAND_CAPACITY = 1024;
+
+    enum class Bus : std::uint8_t
+    {
+        Sfx,
+        Music,
+        Ambience,
+        Ui,
+        Count
+    };
+
+    enum class Backend : std::uint8_t
+    {
+        Default,  // Platform device, falling back to Null if none opens
+        Null,     // miniaudio's null device: real-time callbacks, no sound card
+        None      // No device; the caller drives mix() (offline rendering, benchmarks)
+    };
+
+    struct Config
+    {
+        std::uint32_t sample_rate = 48000;
+        std::uint32_t period_frames = 256;  // Callback size; lower = less latency, more wakeups
+        Backend backend = Backend::Default;
+
+        // Decoded frames buffered per stream (rounded up to a power of two); 16384 = 128 KiB, ~340 ms
+        std::uint32_t stream_buffer_frames = 16384;
+    };
+
+    // Read by init()
+    inline Config config;
+
+    struct PlayParams
+    {
+        float volume = 1.f;
+        float pan = 0.f;  // -1 = left, 1 = right
+        Bus bus = Bus::Sfx;
+        bool loop = false;
+    };
+
+    // Identifies one playback; 0 = none. Stale ids are ignored.
+    using VoiceId = std::uint32_t;
+
+    struct Stats
+    {
+        std::uint64_t callbacks = 0;
+        std::uint64_t frames = 0;
+        std::uint32_t voices = 0;        // Playing after the last callback
+        std::uint64_t mix_ns_last = 0;   // Time spent in the last callback
+        std::uint64_t mix_ns_max = 0;
+        std::uint64_t stolen = 0;        // Voices cut to make room for a new one
+        std::uint64_t dropped = 0;       // Commands lost to a full queue
+
+        std::uint32_t streams = 0;       // Streams being decoded
+        std::size_t stream_bytes = 0;    // Ring memory they hold
+        std::uint64_t underruns = 0;     // Callbacks where a stream's ring ran dry
+    };
+
+    inline ResourcePool<Sound> sounds;
+
+    // Opens the device per config.backend; false if none could be opened, then play() returns 0
+    bool init();
+    void shutdown();
+    bool running();
+
+    // Frees what the audio thread is done with; once per frame
+    void update();
+
+    SoundHandle load_sound(const std::string& name);
+    SoundHandle find_sound(const std::string& name);
+    // Stops its voices first; the memory goes once the audio thread has let go
+    void unload_sound(SoundHandle handle);
+
+    VoiceId play(SoundHandle sound, const PlayParams& params = {});
+    /**
+     * @brief Decode while playing instead of up front, for music and long ambiences.
+     *
+     * The asset is read from its pack or a mapping of the loose file and
+     * decoded by a background thread into a per-voice ring, so memory stays
+     * at config.stream_buffer_frames whatever the track length. Store audio
+     * uncompressed in packs; compressed entries are inflated whole.
+     */
+    VoiceId play_stream(const std::string& name, const PlayParams& params = {.bus = Bus::Music});
+
+    void stop(VoiceId voice);
+    void stop_all();
+    void pause(VoiceId voice, bool paused);
+    void set_volume(VoiceId voice, float volume);
+    void set_pan(VoiceId voice, float pan);
+
+    void set_bus_volume(Bus bus, float volume);
+    void set_master_volume(float volume);
+
+    /**
+     * @brief Mix the next frames into out (interleaved stereo f32).
+     *
+     * This is the device callback. Only call it yourself with Backend::None,
+     * from one thread at a time.
+     */
+    void mix(float* out, std::uint32_t frames);
+
+    Stats stats();
+}  // namespace audio
+}  // namespace kine
@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace kine
+{
+
+/**
+ * @brief Bounded lock-free queue, many producers and a single consumer.
+ *
+ * Each cell carries a sequence number telling producers whether it is free
+ * for position pos (seq == pos) and the consumer whether it holds position
+ * pos (seq == pos + 1). Producers claim a position with one CAS; nothing
+ * ever blocks or allocates, so try_pop() is safe on a real-time thread.
+ */
+template <typename T, std::size_t N>
+class MpscQueue
+{
+    static_assert(std::has_single_bit(N), "MpscQueue capacity must be a power of two");
+
+   public:
+    MpscQueue()
+    {
+        for (std::size_t i = 0; i < N; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // False when full
+    bool try_push(const T& value)
+    {
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell& cell = cells[pos & (N - 1)];
+            const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only
+    bool try_pop(T& out)
+    {
+        Cell& cell = cells[tail & (N - 1)];
+        const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (seq != tail + 1) return false;
+
+        out = cell.value;
+        cell.sequence.store(tail + N, std::memory_order_release);
+        ++tail;
+        return true;
+    }
+
+    static constexpr std::size_t capacity() { return N; }
+
+   private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::array<Cell, N> cells;
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::size_t tail = 0;
+};
+
+}  // namespace kine
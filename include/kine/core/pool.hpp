@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace kine
+{
+
+/**
+ * @brief Fixed-size block allocator.
+ *
+ * Blocks are carved out of large chunks and recycled through an intrusive
+ * free list, so allocate() and deallocate() are both O(1) and never touch
+ * the global heap once the pool is warm. Not thread-safe.
+ */
+class BlockPool
+{
+   public:
+    explicit BlockPool(std::size_t block_size, std::size_t blocks_per_chunk = 256);
+    ~BlockPool();
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    void* allocate();
+    void deallocate(void* p);
+
+    std::size_t block_size() const { return size; }
+    std::size_t live() const { return live_blocks; }
+    std::size_t reserved() const { return chunks.size() * per_chunk; }
+
+   private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    std::size_t size;
+    std::size_t per_chunk;
+    std::size_t live_blocks = 0;
+
+    FreeBlock* free_list = nullptr;
+    std::vector<std::byte*> chunks;
+
+    void add_chunk();
+};
+
+/**
+ * @brief Size-class pools backing FlowObject allocation.
+ *
+ * Requests are rounded up to the next power-of-two class (64..2048 bytes)
+ * and served from that class' BlockPool. Anything bigger falls back to the
+ * global heap.
+ */
+namespace flow_pool
+{
+    inline constexpr std::size_t MIN_CLASS = 64;
+    inline constexpr std::size_t MAX_CLASS = 2048;
+
+    struct Stats
+    {
+        std::size_t live = 0;       // Blocks currently handed out
+        std::size_t reserved = 0;   // Blocks owned by the pools
+        std::size_t bytes = 0;      // Bytes owned by the pools
+        std::size_t oversized = 0;  // Live allocations served by the global heap
+    };
+
+    void* allocate(std::size_t size);
+    void deallocate(void* p, std::size_t size);
+
+    Stats stats();
+}  // namespace flow_pool
+
+}  // namespace kine
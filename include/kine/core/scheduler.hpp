@@ -39,6 +39,11 @@ bool add_dependency(const std::string& before, const std::string& after);
 bool rebuild_order();
 
 void update(ECS& ecs, float dt, float alpha);
+
+// Run every system once with the fixed timestep
+void fixed_step(ECS& ecs, float fixed_dt, float alpha);
+
+// Drain the accumulator in fixed steps, at most time::max_substeps; leftover time past the cap is dropped
 void fixed_update(ECS& ecs, float& accumulator, float fixedDt, float alpha);
 
 // private:
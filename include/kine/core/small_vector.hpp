@@ -0,0 +1,198 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace kine
+{
+
+/**
+ * @brief Vector with inline storage for the first N elements.
+ *
+ * Only spills to the heap once it grows past N, so small lists
+ * (children of a leaf node, a couple of groups) cost no allocation.
+ * Erasing keeps element order.
+ */
+template <typename T, std::size_t N>
+class SmallVector
+{
+   public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+
+    SmallVector(const SmallVector& other)
+    {
+        reserve(other.count);
+        for (const T& v : other) push_back(v);
+    }
+
+    SmallVector(SmallVector&& other) noexcept { take(std::move(other)); }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this == &other) return *this;
+        clear();
+        reserve(other.count);
+        for (const T& v : other) push_back(v);
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept
+    {
+        if (this == &other) return *this;
+        clear();
+        release_heap();
+        take(std::move(other));
+        return *this;
+    }
+
+    ~SmallVector()
+    {
+        clear();
+        release_heap();
+    }
+
+    iterator begin() { return ptr; }
+    iterator end() { return ptr + count; }
+    const_iterator begin() const { return ptr; }
+    const_iterator end() const { return ptr + count; }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return cap; }
+    bool empty() const { return count == 0; }
+    bool is_inline() const { return ptr == inline_ptr(); }
+
+    T& operator[](std::size_t i) { return ptr[i]; }
+    const T& operator[](std::size_t i) const { return ptr[i]; }
+
+    T& front() { return ptr[0]; }
+    T& back() { return ptr[count - 1]; }
+    const T& front() const { return ptr[0]; }
+    const T& back() const { return ptr[count - 1]; }
+
+    void reserve(std::size_t n)
+    {
+        if (n > cap) grow(n);
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (count == cap) return emplace_grow(std::forward<Args>(args)...);
+        T* slot = ::new (static_cast<void*>(ptr + count)) T(std::forward<Args>(args)...);
+        ++count;
+        return *slot;
+    }
+
+    void push_back(const T& v) { emplace_back(v); }
+    void push_back(T&& v) { emplace_back(std::move(v)); }
+
+    void pop_back() { std::destroy_at(ptr + --count); }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        T* f = ptr + (first - ptr);
+        T* l = ptr + (last - ptr);
+        if (f == l) return f;
+
+        T* out = std::move(l, end(), f);
+        std::destroy(out, end());
+        count = static_cast<std::uint32_t>(out - ptr);
+        return f;
+    }
+
+    void clear()
+    {
+        std::destroy(begin(), end());
+        count = 0;
+    }
+
+   private:
+    alignas(T) std::byte storage[sizeof(T) * N];
+    T* ptr = inline_ptr();
+    std::uint32_t count = 0;
+    std::uint32_t cap = N;
+
+    T* inline_ptr() { return std::launder(reinterpret_cast<T*>(storage)); }
+    const T* inline_ptr() const { return std::launder(reinterpret_cast<const T*>(storage)); }
+
+    void grow(std::size_t n)
+    {
+        if (n < 4) n = 4;
+
+        T* fresh = static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+        std::uninitialized_move(begin(), end(), fresh);
+        std::destroy(begin(), end());
+        release_heap();
+
+        ptr = fresh;
+        cap = static_cast<std::uint32_t>(n);
+    }
+
+    // The new element is built before the old ones move out, since args may refer to one of them
+    template <typename... Args>
+    T& emplace_grow(Args&&... args)
+    {
+        const std::size_t n = cap * 2 < 4 ? 4 : std::size_t(cap) * 2;
+        T* fresh = static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+
+        T* slot;
+        try
+        {
+            slot = ::new (static_cast<void*>(fresh + count)) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            ::operator delete(fresh, std::align_val_t{alignof(T)});
+            throw;
+        }
+
+        std::uninitialized_move(begin(), end(), fresh);
+        std::destroy(begin(), end());
+        release_heap();
+
+        ptr = fresh;
+        cap = static_cast<std::uint32_t>(n);
+        ++count;
+        return *slot;
+    }
+
+    void release_heap()
+    {
+        if (!is_inline()) ::operator delete(ptr, std::align_val_t{alignof(T)});
+        ptr = inline_ptr();
+        cap = N;
+    }
+
+    // Expects *this to be empty and inline
+    void take(SmallVector&& other)
+    {
+        if (other.is_inline())
+        {
+            std::uninitialized_move(other.begin(), other.end(), ptr);
+            count = other.count;
+            other.clear();
+            return;
+        }
+
+        ptr = other.ptr;
+        count = other.count;
+        cap = other.cap;
+
+        other.ptr = other.inline_ptr();
+        other.count = 0;
+        other.cap = N;
+    }
+};
+
+}  // namespace kine
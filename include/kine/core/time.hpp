@@ -8,8 +8,29 @@ inline float accumulator = 0.0f;
 inline float fixed_dt = 1.0f / 60.0f;
 inline float alpha = 0.0f;
 
+// Spiral-of-death guards: a long frame is clamped to max_frame_dt, and at
+// most max_substeps fixed steps run per frame. Leftover time is dropped.
+inline float max_frame_dt = 0.25f;
+inline int max_substeps = 8;
+
+// Fixed steps taken so far this frame
+inline int substeps = 0;
+
 void begin_frame();
+// Advance to a given clock reading and frame time instead of reading GLFW (replays)
+void begin_frame(double clock, float frame_dt);
+
+/**
+ * @brief Consume one fixed step from the accumulator.
+ *
+ * Drive the fixed-rate simulation with `while (time::step()) { ... }`.
+ * Once it returns false, alpha holds the interpolation factor between
+ * the previous and current simulation state for rendering.
+ */
+bool step();
 
 inline float last_frame_time = 0.0f;
+// Clock reading taken by begin_frame(), same clock as input event timestamps
+inline double now = 0.0;
 
 }  // namespace kine::time
@@ -105,6 +105,20 @@ class ECS
         if (reg.valid(e)) reg.destroy(e);
     }
 
+    // Batched variants: one pass over the component pools for the whole range
+    template <typename It>
+    void create(It first, It last)
+    {
+        reg.create(first, last);
+    }
+
+    // Every entity in the range must be valid and unique
+    template <typename It>
+    void destroy(It first, It last)
+    {
+        reg.destroy(first, last);
+    }
+
     template <typename... Components>
     auto view()
     {
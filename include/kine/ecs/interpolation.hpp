@@ -0,0 +1,81 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "kine/ecs/ecs.hpp"
+
+namespace kine
+{
+
+/**
+ * @brief Value of component T as of the start of the last fixed step.
+ *
+ * Maintained by interpolation::snapshot() for every tracked T, so rendering
+ * can blend between the previous and current simulation state.
+ */
+template <typename T>
+struct Previous
+{
+    T value;
+};
+
+namespace interpolation
+{
+    using SnapshotFunc = void (*)(ECS&);
+
+    // Snapshot callbacks, one per tracked component type
+    inline std::vector<SnapshotFunc> tracked;
+
+    template <typename T>
+    void snapshot_component(ECS& ecs)
+    {
+        for (Entity e : ecs.view<T>())
+        {
+            const T& cur = e.get<T>();
+            e.add_or_get<Previous<T>>(cur).value = cur;
+        }
+    }
+
+    /**
+     * @brief Keep a Previous<T> copy of every T, refreshed before each fixed step.
+     */
+    template <typename T>
+    void track()
+    {
+        SnapshotFunc fn = &snapshot_component<T>;
+        if (std::find(tracked.begin(), tracked.end(), fn) == tracked.end()) tracked.push_back(fn);
+    }
+
+    // Called by the fixed-step driver right before each step
+    inline void snapshot(ECS& ecs)
+    {
+        for (SnapshotFunc fn : tracked) fn(ecs);
+    }
+
+    inline void reset() { tracked.clear(); }
+
+    /**
+     * @brief Blend two states. Overload blend() for your own component types.
+     */
+    template <typename T>
+    T blend(const T& prev, const T& cur, float alpha)
+    {
+        return prev + (cur - prev) * alpha;
+    }
+
+    /**
+     * @brief Render-time value of T: previous and current state blended by alpha.
+     *
+     * Falls back to the current value before the first snapshot.
+     */
+    template <typename T>
+    T get(Entity e, float alpha)
+    {
+        const T& cur = e.get<T>();
+        if (!e.has<Previous<T>>()) return cur;
+
+        return blend(e.get<Previous<T>>().value, cur, alpha);
+    }
+}  // namespace interpolation
+
+}  // namespace kine
@@ -1,24 +1,75 @@
 #pragma once
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <unordered_set>
+#include <string_view>
+#include <typeindex>
+#include <unordered_map>
 #include <vector>
 
+#include "kine/core/pool.hpp"
+#include "kine/core/small_vector.hpp"
 #include "kine/ecs/ecs.hpp"
 
 namespace kine
 {
 
 class FlowTree;
+class FlowObject;
+
+/**
+ * @brief Interned group name.
+ *
+ * Group names are mapped to dense integer ids once, so membership checks
+ * and the FlowTree group registry never hash strings.
+ */
+using GroupId = std::uint32_t;
+
+inline constexpr GroupId INVALID_GROUP = UINT32_MAX;
+
+GroupId group_id(std::string_view name);
+GroupId find_group_id(std::string_view name);
+const std::string& group_name(GroupId id);
+
+struct GroupMembership
+{
+    GroupId id = INVALID_GROUP;
+    std::uint32_t slot = UINT32_MAX;  // Index into FlowTree's member list while attached
+};
+
+/**
+ * @brief Attached nodes of one dynamic type.
+ *
+ * FlowTree keeps one bucket per concrete node type, updated on attach and
+ * destruction, so type queries cost O(types + results) instead of a DFS.
+ */
+struct TypeBucket
+{
+    std::type_index type;
+    std::vector<FlowObject*> members;
+};
+
+const std::vector<TypeBucket>& type_buckets(const FlowTree* tree);
+const FlowObject* tree_root(const FlowTree* tree);
 
 class FlowObject
 {
    public:
     virtual ~FlowObject();
 
+    /**
+     * @brief Nodes are allocated from size-class pools (see flow_pool).
+     *
+     * The sized delete receives the dynamic size through the virtual
+     * destructor, so freeing a node is an O(1) free-list push.
+     */
+    static void* operator new(std::size_t size) { return flow_pool::allocate(size); }
+    static void operator delete(void* p, std::size_t size) { flow_pool::deallocate(p, size); }
+
     std::string name;
     FlowObject* parent = nullptr;
-    std::vector<std::unique_ptr<FlowObject>> children;
-    std::unordered_set<std::string> groups;
+    SmallVector<std::unique_ptr<FlowObject>, 4> children;
+    SmallVector<GroupMembership, 2> groups;
 
     bool enabled = true;
     bool pause_mode = false;
@@ -27,6 +78,11 @@ class FlowObject
 
     Entity entity;
 
+    // Tree this node is attached to (set by FlowTree::finalize)
+    FlowTree* tree = nullptr;
+    std::uint32_t type_bucket = UINT32_MAX;
+    std::uint32_t type_slot = UINT32_MAX;
+
     /**
      * @brief Called when the node is attached to a FlowTree.
      *
@@ -75,42 +131,111 @@ class FlowObject
 
         T* raw = child.get();
         children.push_back(std::move(child));
+        name_index_dirty = true;
+
+        // Children of a live node are attached at the tree's next flush()
+        if (tree) queue_attach(raw);
         return raw;
     }
 
     void remove_child(FlowObject* child, bool free_memory = true);
     void reparent(FlowObject* new_parent);
 
-    FlowObject* find(const std::string& path);
-    FlowObject* find_or_null(const std::string& path);
+    /**
+     * @brief Reparent at the tree's next flush() instead of immediately.
+     *
+     * Safe to call while the tree is being updated.
+     */
+    void queue_reparent(FlowObject* new_parent);
+
+    /**
+     * @brief Resolve a relative path such as "Player/Sprite" or "../Enemy".
+     *
+     * Segments are parsed in place (no allocation). Children are looked up
+     * through a per-parent name index once a node has more than
+     * NAME_INDEX_THRESHOLD children, and by a linear scan below that.
+     */
+    FlowObject* find(std::string_view path);
+    FlowObject* find_or_null(std::string_view path);
 
+    FlowObject* find_child(std::string_view name);
+
+    /**
+     * @brief Collect this node and all descendants of type T.
+     *
+     * On the root of a finalized tree this reads the tree's type registry:
+     * results are grouped by concrete type, but their order within a type is
+     * unspecified (removal swaps the last member in). Elsewhere it falls
+     * back to a DFS in tree order. Both skip subtrees still waiting to be
+     * attached by the next flush.
+     */
     template <typename T>
     void find_all(std::vector<T*>& out)
     {
         static_assert(std::is_base_of_v<FlowObject, T>, "T must derive from FlowObject");
+
+        if (tree && tree_root(tree) == this)
+        {
+            for (const TypeBucket& bucket : type_buckets(tree))
+            {
+                if (bucket.members.empty() || !dynamic_cast<T*>(bucket.members.front())) continue;
+                for (FlowObject* obj : bucket.members) out.push_back(dynamic_cast<T*>(obj));
+            }
+            return;
+        }
+
         if (auto* self = dynamic_cast<T*>(this)) out.push_back(self);
-        for (auto& child : children) child->find_all<T>(out);
+        for (auto& child : children)
+            if (!child->pending_attach) child->find_all<T>(out);
     }
 
     template <typename T>
     T* find_type()
     {
+        if (tree && tree_root(tree) == this)
+        {
+            for (const TypeBucket& bucket : type_buckets(tree))
+                if (!bucket.members.empty())
+                    if (auto* found = dynamic_cast<T*>(bucket.members.front())) return found;
+            return nullptr;
+        }
+
         if (auto* self = dynamic_cast<T*>(this)) return self;
 
         for (auto& c : children)
-            if (auto* found = c->find_type<T>()) return found;
+            if (!c->pending_attach)
+                if (auto* found = c->find_type<T>()) return found;
 
         return nullptr;
     }
 
-    void add_to_group(const std::string& group);
-    void remove_from_group(const std::string& group);
-    bool is_in_group(const std::string& group) const;
+    void add_to_group(std::string_view group);
+    void add_to_group(GroupId group);
+    void remove_from_group(std::string_view group);
+    void remove_from_group(GroupId group);
+    bool is_in_group(std::string_view group) const;
+    bool is_in_group(GroupId group) const;
 
+    /**
+     * @brief Free this node and its subtree at the tree's next flush().
+     */
     void queue_free();
 
+    static constexpr std::size_t NAME_INDEX_THRESHOLD = 8;
+
    private:
     friend class FlowTree;
+
+    // Name hash -> position in children. Entries are verified against the
+    // child's name on use, so renames and stale positions fall back to a scan.
+    std::unordered_map<std::size_t, std::uint32_t> name_index;
+    bool name_index_dirty = true;
+
+    bool pending_attach = false;  // Waiting in FlowTree's spawn queue
+    bool detached = false;        // Already detached by a batched free
+
+    void rebuild_name_index();
+    void queue_attach(FlowObject* child);
 };
 
 }  // namespace kine
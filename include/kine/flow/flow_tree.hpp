@@ -1,4 +1,11 @@
 #pragma once
+#include <functional>
+#include <string_view>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "flow_object.hpp"
 
 namespace kine
@@ -57,14 +64,115 @@ class FlowTree
      */
     void fixed_update(float dt);
 
-    void remove_queued_objs();
+    /**
+     * @brief Apply every structural change queued since the last flush.
+     *
+     * This is the tree's sync point. In order, it:
+     * - Applies queue_reparent() moves
+     * - Attaches children added to live nodes (entities created in one batch,
+     *   then on_attach() and init())
+     * - Frees queue_free() subtrees (on_detach(), entities destroyed in one
+     *   batch, each parent's child list compacted once)
+     * - Runs ECS commands recorded with defer()
+     *
+     * Called by kine::update() once per frame.
+     */
+    void flush();
+
+    // Kept for compatibility, same as flush()
+    void remove_queued_objs() { flush(); }
+
+    /**
+     * @brief Record an ECS change to run at the next flush().
+     *
+     * Use this for component adds/removes from inside update callbacks or
+     * scheduler systems, where changing component pools would invalidate
+     * views being iterated.
+     */
+    void defer(std::function<void(ECS&)> command) { pending_commands.push_back(std::move(command)); }
+
+    template <typename T, typename... Args>
+    void defer_add(Entity e, Args&&... args)
+    {
+        defer([e, ... args = std::forward<Args>(args)](ECS&) mutable
+              { if (e.valid() && !e.has<T>()) e.add<T>(std::move(args)...); });
+    }
+
+    template <typename T>
+    void defer_remove(Entity e)
+    {
+        defer([e](ECS&) mutable { e.remove<T>(); });
+    }
+
+    bool has_pending() const
+    {
+        return !pending_free.empty() || !pending_attach.empty() || !pending_reparents.empty() ||
+               !pending_commands.empty();
+    }
+
+    /**
+     * @brief All attached nodes in a group, in no particular order.
+     *
+     * O(1): the tree keeps a dense member list per group, updated by
+     * add_to_group(), remove_from_group() and node destruction.
+     */
+    const std::vector<FlowObject*>& get_group(std::string_view group) const;
+    const std::vector<FlowObject*>& get_group(GroupId group) const;
+
+    /**
+     * @brief Call fn(FlowObject*) on every member of a group.
+     *
+     * Costs O(members). fn may remove the node it is given from the group;
+     * other membership changes during the call may skip members.
+     */
+    template <typename F>
+    void call_group(std::string_view group, F&& fn)
+    {
+        const GroupId id = find_group_id(group);
+        if (id >= group_members.size()) return;
+
+        auto& members = group_members[id];
+        for (size_t i = members.size(); i-- > 0;)
+            if (i < members.size()) fn(members[i]);
+    }
 
    private:
+    friend class FlowObject;
+    friend const std::vector<TypeBucket>& type_buckets(const FlowTree*);
+    friend const FlowObject* tree_root(const FlowTree*);
+
+    // Indexed by GroupId. Declared before root so it outlives the nodes.
+    std::vector<std::vector<FlowObject*>> group_members;
+
+    // One bucket per concrete node type, see TypeBucket
+    std::vector<TypeBucket> types;
+    std::unordered_map<std::type_index, std::uint32_t> type_lookup;
+
+    // Structural change queues, drained by flush()
+    std::vector<FlowObject*> pending_free;
+    std::vector<FlowObject*> pending_attach;
+    std::vector<std::pair<FlowObject*, FlowObject*>> pending_reparents;
+    std::vector<std::function<void(ECS&)>> pending_commands;
+
+    // Reused between flushes
+    std::vector<FlowObject*> scratch_nodes;
+    std::vector<FlowObject*> scratch_parents;
+    std::vector<entt::entity> scratch_entities;
+
     std::unique_ptr<FlowObject> root;
     bool ready = false;
 
-    void attach_recursive(FlowObject*);
-    void init_recursive(FlowObject*);
+    void group_add(FlowObject*, GroupId);
+    void group_remove(FlowObject*, GroupId);
+
+    void type_add(FlowObject*);
+    void type_remove(FlowObject*);
+
+    void attach_subtrees(const std::vector<FlowObject*>& roots);
+    void free_subtrees(const std::vector<FlowObject*>& queued);
+    void detach_recursive(FlowObject*);
+    void forget(FlowObject*);
+
     void update_recursive(FlowObject*, float);
     void fixed_update_recursive(FlowObject*, float);
 };
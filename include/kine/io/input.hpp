@@ -1,9 +1,14 @@
 #pragma once
 #include <array>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "kine/core/mpsc_queue.hpp"
 #include "kine/math.hpp"
 #include "kine/render/window.hpp"
 
@@ -12,26 +17,112 @@ namespace kine
 
 #define MAX_KEYS 512
 #define MAX_MOUSE_BUTTONS 8
+#define MAX_GAMEPAD_BUTTONS 15  // GLFW_GAMEPAD_BUTTON_LAST + 1
+#define MAX_GAMEPAD_AXES 6      // GLFW_GAMEPAD_AXIS_LAST + 1
+#define MAX_ACTIONS 256
+#define INPUT_QUEUE_CAPACITY 1024
 
-struct ActionBinding
+enum class InputEventType : uint8_t
 {
-    std::vector<int> keys;
-    std::vector<int> mouse_buttons;
+    Key,
+    MouseButton,
+    MouseMove,
+    Scroll,
+    GamepadButton,
+    GamepadAxis
 };
 
+struct InputEvent
+{
+    double time = 0.0;  // Seconds on the glfwGetTime() clock
+    InputEventType type = InputEventType::Key;
+    bool down = false;
+    int16_t code = 0;  // Key, mouse button, gamepad button or axis
+    vec2 value{0.f};   // Cursor position, scroll offset or axis value in x
+};
+
+// Dense index into the action table, handed out by input::action()
+using ActionId = uint16_t;
+inline constexpr ActionId INVALID_ACTION = UINT16_MAX;
+
+enum class BindingSource : uint8_t
+{
+    Key,
+    MouseButton,
+    GamepadButton,
+    GamepadAxis
+};
+
+struct Binding
+{
+    ActionId action = INVALID_ACTION;
+    BindingSource source = BindingSource::Key;
+    int16_t code = 0;
+    float scale = 1.f;  // Contribution to the action's value; -1 for the negative half of an axis
+};
+
+// Held state plus the transitions seen since the window started
+template <std::size_t N>
+struct ButtonState
+{
+    std::array<bool, N> down{};
+    std::array<uint8_t, N> presses{};
+    std::array<uint8_t, N> releases{};
+    std::array<double, N> press_time{};  // Latest press in the window
+};
+
+struct InputState
+{
+    ButtonState<MAX_KEYS> keys;
+    ButtonState<MAX_MOUSE_BUTTONS> mouse;
+
+    vec2 mouse_position{0.f};
+    vec2 prev_mouse_position{0.f};
+    vec2 mouse_scroll{0.f};
+
+    ButtonState<MAX_GAMEPAD_BUTTONS> pad;
+    std::array<float, MAX_GAMEPAD_AXES> axes{};
+};
+
+// Every action evaluated once per frame or step, so queries are bit tests
+struct ActionState
+{
+    std::bitset<MAX_ACTIONS> down;
+    std::bitset<MAX_ACTIONS> pressed;
+    std::bitset<MAX_ACTIONS> released;
+    std::array<float, MAX_ACTIONS> values{};  // Summed binding contributions, clamped to [-1, 1]
+};
+
+/**
+ * @brief Input built from a timestamped event stream.
+ *
+ * GLFW callbacks push events into a lock-free queue. begin_frame() drains it
+ * into the frame's event list and applies them to `frame`, so a press and
+ * release within one frame still reports key_pressed and key_released.
+ * During a fixed step, the driver hands each step only the events that fell
+ * in its slice of time and queries answer from `step` instead.
+ */
 struct Input
 {
-    std::array<bool, MAX_KEYS> current_keys;
-    std::array<bool, MAX_KEYS> prev_keys;
+    InputState frame;
+    InputState step;
+    ActionState frame_actions;
+    ActionState step_actions;
+    bool in_step = false;
+    bool live = true;  // Window callbacks and gamepad polling feed the queue; off while replaying
 
-    std::array<bool, MAX_MOUSE_BUTTONS> current_mouse;
-    std::array<bool, MAX_MOUSE_BUTTONS> prev_mouse;
+    MpscQueue<InputEvent, INPUT_QUEUE_CAPACITY> queue;
+    std::vector<InputEvent> events;   // This frame's, oldest first
+    std::vector<InputEvent> pending;  // Not yet handed to a fixed step
+    std::size_t step_count = 0;       // Front of pending that belongs to the current step
+    std::atomic<uint64_t> dropped{0};  // Events lost to a full queue
 
-    vec2 mouse_position;
-    vec2 prev_mouse_position;
-    vec2 mouse_scroll;
+    std::vector<std::string> action_names;  // Indexed by ActionId
+    std::unordered_map<std::string, ActionId> action_ids;
+    std::vector<Binding> bindings;  // Kept sorted by action
 
-    std::unordered_map<std::string, ActionBinding> bindings;
+    int gamepad = -1;  // GLFW joystick polled as the gamepad, -1 = first one connected
+    float deadzone = 0.15f;
 };
 
 namespace input
@@ -42,19 +133,71 @@ namespace input
     void begin_frame(Input* i);
     void shutdown(Input* i);
 
+    // Current time on the event clock
+    double now();
+
+    void push_event(Input* i, const InputEvent& event);
+
+    // Queue an event stamped now(); applied at the next begin_frame()
     void set_key_state(Input* i, int key, bool down);
     void set_mouse_button_state(Input* i, int button, bool down);
     void set_mouse_position(Input* i, float x, float y);
     void set_mouse_scroll(Input* i, float x, float y);
 
+    /**
+     * @brief Enter a fixed step covering events up to `until`.
+     *
+     * Called by the fixed-step driver. Until end_step(), queries answer for
+     * this step only and step_events() lists the events it consumed.
+     */
+    void begin_step(Input* i, double until);
+    void end_step(Input* i);
+
+    std::span<const InputEvent> frame_events(const Input* i);
+    std::span<const InputEvent> step_events(const Input* i);
+
     bool key_down(Input* i, int key);
     bool key_pressed(Input* i, int key);
     bool key_released(Input* i, int key);
+    // When the latest press in the current frame or step happened, negative if none
+    double key_pressed_time(Input* i, int key);
 
     bool mouse_down(Input* i, int button);
     bool mouse_pressed(Input* i, int button);
     bool mouse_released(Input* i, int button);
 
+    vec2 mouse_position(Input* i);
+    vec2 mouse_delta(Input* i);
+    vec2 mouse_scroll(Input* i);
+
+    bool gamepad_down(Input* i, int button);
+    bool gamepad_pressed(Input* i, int button);
+    bool gamepad_released(Input* i, int button);
+    // Raw axis value, deadzone not applied
+    float gamepad_axis(Input* i, int axis);
+
+    /**
+     * @brief Register an action, or look up one already registered.
+     *
+     * Resolve names once at setup and keep the id: queries by id are a bit
+     * test against the table evaluated in begin_frame() / begin_step().
+     */
+    ActionId action(Input* i, const std::string& name);
+
+    void bind(Input* i, const Binding& binding);
+    void bind_key(Input* i, ActionId action, int key, float scale = 1.f);
+    void bind_mouse_button(Input* i, ActionId action, int button, float scale = 1.f);
+    void bind_gamepad_button(Input* i, ActionId action, int button, float scale = 1.f);
+    // Axes count as down past half travel in the direction of scale
+    void bind_gamepad_axis(Input* i, ActionId action, int axis, float scale = 1.f);
+    void clear_bindings(Input* i, ActionId action);
+
+    bool action_down(Input* i, ActionId action);
+    bool action_pressed(Input* i, ActionId action);
+    bool action_released(Input* i, ActionId action);
+    float action_value(Input* i, ActionId action);
+
+    // By name; hashes on every call, prefer the ActionId overloads in hot code
     void bind_key(Input* i, const std::string& action, int key);
     void bind_mouse_button(Input* i, const std::string& action, int button);
     bool is_action_down(Input* i, const std::string& action);
@@ -0,0 +1,103 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kine/io/input.hpp"
+
+/**
+ * @brief Deterministic input recording and playback.
+ *
+ * A recording holds, per frame, the clock reading time::begin_frame() took
+ * and every input event the frame consumed. Playing it back swaps the live
+ * clock and devices for those, so the same frames run the same fixed steps
+ * with the same input on every machine, as fast as the game can go.
+ *
+ * Layout: Header, then per frame: f64 clock, f32 dt, u32 event count, then
+ * per event f64 time, u8 type, u8 down, i16 code, and f32 x, y for events
+ * that carry a value (cursor, scroll, axis).
+ */
+namespace kine::replay
+{
+
+inline constexpr std::uint32_t MAGIC = 0x5045524B;  // "KREP"
+inline constexpr std::uint32_t VERSION = 1;
+
+struct Header
+{
+    std::uint32_t magic = MAGIC;
+    std::uint32_t version = VERSION;
+    std::uint32_t frame_count = 0;
+    std::int32_t max_substeps = 0;
+
+    // Fixed-step state when recording began; restored before playback
+    float fixed_dt = 0.f;
+    float max_frame_dt = 0.f;
+    float accumulator = 0.f;
+    float last_frame_time = 0.f;
+
+    std::uint64_t seed = 0;
+};
+
+static_assert(sizeof(Header) == 40);
+
+enum class Mode : std::uint8_t
+{
+    Off,
+    Record,
+    Replay
+};
+
+struct Timings
+{
+    std::size_t frames = 0;
+    double mean_ms = 0.0;
+    double p50_ms = 0.0;
+    double p90_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+struct Replay
+{
+    Mode mode = Mode::Off;
+    std::string path;
+
+    Header header;
+    std::vector<std::byte> data;  // Frames written so far, or the whole file being played
+    std::size_t cursor = 0;
+    std::uint32_t frame = 0;
+
+    // Seed game randomness from this once a recording or replay has started
+    std::uint64_t seed = 0;
+
+    // Wall time between consecutive begin_frame() calls while replaying
+    std::vector<float> frame_ms;
+    std::chrono::steady_clock::time_point frame_start;
+};
+
+// Record from the next frame on; written to path by stop()
+void start_recording(Replay* r, const std::string& path, std::uint64_t seed);
+// Load a recording and restore the fixed-step state it began with. False if missing or malformed.
+bool start_replay(Replay* r, const std::string& path);
+// Writes the recording, or logs the timing report of a replay
+void stop(Replay* r);
+
+/**
+ * @brief Stand-in for time::begin_frame() while replaying.
+ *
+ * Advances the clock to the recorded reading and queues the frame's events
+ * for the following input::begin_frame(). Turn Input::live off first so
+ * real devices stay out. False once the recording is exhausted; the clock
+ * then stands still.
+ */
+bool play_frame(Replay* r, Input* i);
+// After input::begin_frame(): append the frame's clock and events
+void record_frame(Replay* r, const Input* i);
+
+// Frame-time distribution of the replay so far
+Timings timings(const Replay* r);
+
+}  // namespace kine::replay
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "kine/audio/audio.hpp"
 #include "kine/core/scheduler.hpp"
 #include "kine/core/time.hpp"
+#include "kine/ecs/interpolation.hpp"
 #include "kine/flow/flow_tree.hpp"
 #include "kine/io/input.hpp"
+#include "kine/io/replay.hpp"
+#include "kine/physics/physics.hpp"
 #include "kine/render/render_list.hpp"
 #include "kine/render/renderer.hpp"
 #include "kine/render/window.hpp"
@@ -16,6 +20,7 @@ inline bool running = false;
 
 inline Renderer2D renderer;
 inline Input global_input;
+inline replay::Replay replay_session;
 
 inline FlowTree* flow_tree = nullptr;
 
@@ -1,11 +1,20 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <format>
 #include <iostream>
 #include <mutex>
+#include <string>
 #include <string_view>
 #include <utility>
 
+// Levels below this (Trace = 0 ... Critical = 5) compile to nothing
+#ifndef KINE_LOG_MIN_LEVEL
+#    define KINE_LOG_MIN_LEVEL 0
+#endif
+
 namespace kine::log
 {
 enum class Level
@@ -26,13 +35,8 @@ inline Level min_level = Level::Trace;
 inline Level min_level = Level::Info;
 #endif
 
-#ifndef LOG_THREAD_SAFE
-#    define LOG_THREAD_SAFE 1
-#endif
-
-#if LOG_THREAD_SAFE
+// Serializes the sinks
 inline std::mutex log_mutex;
-#endif
 
 inline constexpr std::string_view level_name(Level lvl) noexcept
 {
@@ -86,12 +90,11 @@ inline const std::string_view level_color(Level lvl) noexcept
     }
 }
 
-inline std::string time_string()
+inline std::string time_string(std::chrono::system_clock::time_point when = std::chrono::system_clock::now())
 {
     using namespace std::chrono;
 
-    auto now = system_clock::now();
-    auto t = system_clock::to_time_t(now);
+    auto t = system_clock::to_time_t(when);
 
     std::tm tm{};
 #if defined(_WIN32)
@@ -105,6 +108,7 @@ inline std::string time_string()
     return buf;
 }
 
+// Called on the writer thread, or the logging thread when async is off
 using Handler = void (*)(Level, std::string_view);
 
 inline void default_handler(Level lvl, std::string_view message)
@@ -126,16 +130,108 @@ inline Handler get_handler() noexcept { return handler; }
 
 inline void set_level(Level lvl) noexcept { min_level = lvl; }
 
+inline constexpr std::size_t MESSAGE_CAPACITY = 256;  // Longer messages are truncated
+inline constexpr std::size_t RING_CAPACITY = 1024;
+
+// One formatted message on its way to the writer thread
+struct Record
+{
+    Level level = Level::Info;
+    std::uint32_t length = 0;
+    std::chrono::system_clock::time_point time;
+    char text[MESSAGE_CAPACITY];
+};
+
+// State of one LOG_* call site: its rate limit and the last message it printed
+struct Site
+{
+    std::atomic<std::int64_t> window{0};  // Start of the current one-second window, in ms
+    std::atomic<std::uint32_t> count{0};
+    std::atomic<std::uint32_t> suppressed{0};
+
+    std::atomic<std::uint64_t> last_hash{0};
+    std::atomic<std::int64_t> last_emit{0};  // ms
+    std::atomic<std::uint32_t> repeats{0};
+
+    // For the writer to report repeats of a site that went quiet
+    std::atomic<const char*> format{nullptr};
+    std::atomic<std::size_t> format_size{0};
+    std::atomic<Level> level{Level::Info};
+    std::atomic<bool> listed{false};
+    std::atomic<Site*> next{nullptr};
+};
+
+// Messages per call site per second before the rest are dropped; 0 = unlimited
+inline std::uint32_t site_rate_limit = 32;
+
+/**
+ * @brief Hand a record to the writer thread.
+ *
+ * Lock-free: the record goes into an MPSC ring and a background thread
+ * does the timestamps, colour, sinks and I/O in batches. If the ring is
+ * full the record is dropped and counted. Falls back to writing on the
+ * calling thread when async is off or the writer has shut down.
+ */
+void submit(const Record& record);
+
+/**
+ * @brief Submit on behalf of a call site.
+ *
+ * A message identical to the site's last one within a second is only
+ * counted. The count goes out as "repeated N times" ahead of the next
+ * message that does print, or from the writer once the site has been
+ * quiet for a second.
+ */
+void submit(Site* site, std::string_view format, const Record& record, std::uint32_t suppressed);
+
+// Block until everything submitted so far has reached the sinks
+void flush();
+// Drain and stop the writer; later messages are written synchronously
+void shutdown();
+
+void set_async(bool async);
+
+// Copy every message, without colour, to a file. Written in batches by the writer.
+bool open_file(const std::string& path);
+void close_file();
+
+std::uint64_t dropped();
+
+inline bool enabled(Level lvl) noexcept { return lvl >= min_level && handler; }
+
+// Whether a site may log now; fills in how many of its messages were dropped since it last could
+bool admit(Site* site, Level lvl, std::uint32_t& suppressed);
+
+// Formatted in place on the caller, no heap
+template <typename... Args>
+inline void format_record(Record& r, Level lvl, std::format_string<Args...> fmt, Args&&... args)
+{
+    r.level = lvl;
+    r.time = std::chrono::system_clock::now();
+
+    auto result = std::format_to_n(r.text, MESSAGE_CAPACITY, fmt, std::forward<Args>(args)...);
+    r.length = static_cast<std::uint32_t>(result.out - r.text);
+    if (result.size > std::ptrdiff_t(MESSAGE_CAPACITY)) std::fill_n(r.text + MESSAGE_CAPACITY - 3, 3, '.');
+}
+
 template <typename... Args>
 inline void write(Level lvl, std::format_string<Args...> fmt, Args&&... args)
 {
-    if (lvl < min_level || !handler) return;
+    if (!enabled(lvl)) return;
 
-#if LOG_THREAD_SAFE
-    std::scoped_lock lock(log_mutex);
-#endif
+    Record r;
+    format_record(r, lvl, fmt, std::forward<Args>(args)...);
+    submit(r);
+}
 
-    handler(lvl, std::format(fmt, std::forward<Args>(args)...));
+// What the LOG_* macros call once the site has been admitted
+template <typename... Args>
+inline void write_site(Site* site, std::uint32_t suppressed, Level lvl, std::format_string<Args...> fmt,
+                       Args&&... args)
+{
+    Record r;
+    format_record(r, lvl, fmt, std::forward<Args>(args)...);
+    submit(site, fmt.get(), r, suppressed);
 }
 
 }  // namespace kine::log
@@ -144,24 +240,41 @@ inline void write(Level lvl, std::format_string<Args...> fmt, Args&&... args)
 
 #define UNUSED(value) (void) (value)
 
-#define LOG_TRACE(...) kine::log::write(kine::log::Level::Trace, __VA_ARGS__)
-#define LOG_DEBUG(...) kine::log::write(kine::log::Level::Debug, __VA_ARGS__)
-#define LOG_INFO(...) kine::log::write(kine::log::Level::Info, __VA_ARGS__)
-#define LOG_WARN(...) kine::log::write(kine::log::Level::Warn, __VA_ARGS__)
-#define LOG_ERROR(...) kine::log::write(kine::log::Level::Error, __VA_ARGS__)
-#define LOG_CRITICAL(...) kine::log::write(kine::log::Level::Critical, __VA_ARGS__)
-
-#define LOG_THROW(...)          \
-    do                          \
-    {                           \
-        LOG_ERROR(__VA_ARGS__); \
-        std::abort();           \
+// Each call site gets its own rate limit and repeat filter. Arguments are only
+// evaluated once the level is on and the site is admitted.
+#define KINE_LOG(lvl, ...)                                                                             \
+    do                                                                                                 \
+    {                                                                                                  \
+        if constexpr (static_cast<int>(lvl) >= KINE_LOG_MIN_LEVEL)                                     \
+        {                                                                                              \
+            static kine::log::Site kine_log_site;                                                      \
+            std::uint32_t kine_log_suppressed = 0;                                                     \
+            if (kine::log::enabled(lvl) && kine::log::admit(&kine_log_site, lvl, kine_log_suppressed)) \
+                kine::log::write_site(&kine_log_site, kine_log_suppressed, lvl, __VA_ARGS__);          \
+        }                                                                                              \
+    } while (0)
+
+#define LOG_TRACE(...) KINE_LOG(kine::log::Level::Trace, __VA_ARGS__)
+#define LOG_DEBUG(...) KINE_LOG(kine::log::Level::Debug, __VA_ARGS__)
+#define LOG_INFO(...) KINE_LOG(kine::log::Level::Info, __VA_ARGS__)
+#define LOG_WARN(...) KINE_LOG(kine::log::Level::Warn, __VA_ARGS__)
+#define LOG_ERROR(...) KINE_LOG(kine::log::Level::Error, __VA_ARGS__)
+#define LOG_CRITICAL(...) KINE_LOG(kine::log::Level::Critical, __VA_ARGS__)
+
+// The fatal ones are never stripped or rate limited, and flush before aborting
+#define LOG_THROW(...)                                                 \
+    do                                                                 \
+    {                                                                  \
+        kine::log::write(kine::log::Level::Error, __VA_ARGS__);        \
+        kine::log::flush();                                            \
+        std::abort();                                                  \
     } while (0)
 
 #define LOG_TODO(...)                                          \
     do                                                         \
     {                                                          \
         kine::log::write(kine::log::Level::Todo, __VA_ARGS__); \
+        kine::log::flush();                                    \
         std::abort();                                          \
     } while (0)
 
@@ -169,5 +282,6 @@ inline void write(Level lvl, std::format_string<Args...> fmt, Args&&... args)
     do                                                                \
     {                                                                 \
         kine::log::write(kine::log::Level::Unreachable, __VA_ARGS__); \
+        kine::log::flush();                                           \
         std::abort();                                                 \
     } while (0)
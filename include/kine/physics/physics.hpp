@@ -0,0 +1,278 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "kine/ecs/ecs.hpp"
+#include "kine/physics/shapes.hpp"
+#include "kine/resources/resource_pool.hpp"
+
+/**
+ * @brief Rigid body physics, stepped once per fixed step.
+ *
+ * Bodies live in the World as structure of arrays, indexed by slot. Each
+ * step runs a hashed grid broadphase, narrowphase into cached contacts,
+ * then a sequential impulse solver warm started from last step's impulses.
+ * Bodies touching through dynamic contacts form islands; an island that has
+ * been still for Config::time_to_sleep goes to sleep, dropping out of the
+ * solver until something awake touches it. Islands share no bodies, so with
+ * Config::worker_threads they are solved in parallel. Bodies moving fast
+ * enough to pass through a static body in one step are swept against the
+ * static bodies on their path and stopped at the time of impact.
+ *
+ * Units are world units, pixels in practice, with y down.
+ */
+namespace kine::physics
+{
+
+enum class BodyType : std::uint8_t
+{
+    Static,
+    Kinematic,  // Moved by its velocity only, pushes dynamic bodies
+    Dynamic
+};
+
+struct BodyDef
+{
+    BodyType type = BodyType::Dynamic;
+    Shape shape = box(vec2(8.f));
+
+    vec2 position{0.f};
+    float angle = 0.f;
+    vec2 velocity{0.f};
+    float angular_velocity = 0.f;
+
+    float density = 1.f;
+    float friction = 0.6f;
+    float restitution = 0.f;
+    float linear_damping = 0.f;
+    float angular_damping = 0.f;
+    float gravity_scale = 1.f;
+    bool fixed_rotation = false;
+
+    // Two bodies collide when each one's category is in the other's mask
+    std::uint32_t category = 1;
+    std::uint32_t mask = ~0u;
+};
+
+using BodyId = Handle<BodyDef>;
+
+struct Config
+{
+    vec2 gravity{0.f, 980.f};
+    int velocity_iterations = 8;
+    int relax_iterations = 2;  // Bias-free passes after positions move
+
+    float baumgarte = 0.2f;               // Fraction of overlap removed per step
+    float linear_slop = 0.5f;             // Overlap left alone, keeps resting contacts alive
+    float speculative_margin = 2.f;       // Contacts are made this far before touching
+    float restitution_threshold = 60.f;   // Slower impacts do not bounce
+
+    bool allow_sleep = true;
+    float time_to_sleep = 0.5f;
+    float sleep_linear_velocity = 4.f;
+    float sleep_angular_velocity = 0.05f;
+
+    bool continuous = true;  // Sweep fast bodies against static ones so they cannot tunnel
+
+    float cell_size = 0.f;  // Broadphase grid; 0 sizes it from the dynamic bodies each step
+
+    // Extra threads for the narrowphase and island solving; 0 runs everything on the caller
+    unsigned worker_threads = 0;
+};
+
+struct Stats
+{
+    std::uint32_t bodies = 0;
+    std::uint32_t awake = 0;
+    std::uint32_t pairs = 0;
+    std::uint32_t contacts = 0;
+    std::uint32_t islands = 0;
+    std::uint32_t sleeping_islands = 0;
+
+    // Last step, nanoseconds
+    std::uint64_t broadphase_ns = 0;
+    std::uint64_t narrowphase_ns = 0;
+    std::uint64_t solve_ns = 0;
+    std::uint64_t step_ns = 0;
+};
+
+inline constexpr std::uint32_t NO_ISLAND = ~0u;
+
+// Per body arrays, indexed by slot. Dead slots keep their storage for reuse.
+struct Bodies
+{
+    std::vector<vec2> position;
+    std::vector<float> angle;
+    std::vector<Rotation> rot;
+    std::vector<vec2> velocity;
+    std::vector<float> angular_velocity;
+    std::vector<vec2> force;
+    std::vector<float> torque;
+
+    std::vector<float> inv_mass;
+    std::vector<float> inv_inertia;
+    std::vector<float> friction;
+    std::vector<float> restitution;
+    std::vector<float> linear_damping;
+    std::vector<float> angular_damping;
+    std::vector<float> gravity_scale;
+    std::vector<std::uint32_t> category;
+    std::vector<std::uint32_t> mask;
+
+    std::vector<Shape> shape;
+    std::vector<AABB> aabb;
+    std::vector<float> min_extent;
+    std::vector<float> max_extent;
+    std::vector<BodyType> type;
+
+    std::vector<std::uint8_t> awake;  // Dynamic bodies not asleep, and kinematic ones
+    std::vector<float> sleep_time;
+    std::vector<std::uint32_t> sleep_island;  // Index into World::sleeping when asleep
+
+    std::vector<entt::entity> owner;
+    std::vector<std::uint32_t> generation;
+    std::vector<std::uint8_t> live;
+};
+
+// A touching pair, a < b, with the impulses it ended last step with
+struct Contact
+{
+    std::uint32_t a = 0;
+    std::uint32_t b = 0;
+    Manifold manifold;
+    float friction = 0.f;
+    float restitution = 0.f;
+    float normal_impulse[2] = {0.f, 0.f};
+    float tangent_impulse[2] = {0.f, 0.f};
+};
+
+// Uniform grid hashed into buckets, rebuilt every step and kept for queries
+struct Grid
+{
+    struct Entry
+    {
+        std::uint32_t body;
+        std::int32_t x, y;
+    };
+
+    float cell_size = 64.f;
+    std::uint32_t mask = 0;               // Bucket count - 1
+    std::vector<std::uint32_t> start;     // Bucket b is entries[start[b], start[b + 1])
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> large;     // Bodies covering too many cells to insert
+    float slack = 0.f;                    // How far bodies may have moved since they were inserted
+};
+
+struct World
+{
+    Config config;
+    Bodies bodies;
+    std::uint32_t capacity = 0;
+    std::vector<std::uint32_t> free_slots;
+
+    Grid grid;
+    bool grid_dirty = true;            // A body was added, removed or teleported
+    std::vector<std::uint64_t> pairs;  // a << 32 | b, sorted
+    std::vector<Contact> contacts;     // Sorted by pair
+
+    std::vector<std::vector<std::uint32_t>> sleeping;  // Members of each sleeping island
+    std::vector<std::uint32_t> free_islands;
+
+    Stats stats;
+
+    // Step scratch, kept between steps so they stop allocating
+    std::vector<Grid::Entry> unsorted;
+    std::vector<std::uint64_t> sorted_pairs;
+    std::vector<std::uint8_t> is_large;
+    std::vector<Manifold> manifolds;
+    std::vector<Contact> merged;
+    std::vector<std::uint32_t> parent;
+    std::vector<std::uint32_t> island_of;
+    std::vector<std::uint32_t> island_start;
+    std::vector<std::uint32_t> island_bodies;
+    std::vector<std::uint32_t> contact_start;
+    std::vector<std::uint32_t> island_contacts;
+    std::vector<float> island_sleep;
+    std::vector<float> island_motion;
+};
+
+// ECS side: the body behind an entity, and its pose as of the last step
+struct Body
+{
+    BodyId id;
+};
+
+struct Pose
+{
+    vec2 position{0.f};
+    float angle = 0.f;
+};
+
+inline Pose blend(const Pose& prev, const Pose& cur, float alpha)
+{
+    return {prev.position + (cur.position - prev.position) * alpha, prev.angle + (cur.angle - prev.angle) * alpha};
+}
+
+// Create the ECS's world; physics::step() does nothing until one exists
+World& create_world(ECS& ecs, const Config& config = {});
+World* get_world(ECS& ecs);
+
+BodyId create_body(World* w, const BodyDef& def, entt::entity owner = entt::null);
+// Wakes whatever was resting on it
+void destroy_body(World* w, BodyId id);
+bool valid(const World* w, BodyId id);
+
+/**
+ * @brief Give an entity a body, plus the Body and Pose components mirroring it.
+ *
+ * The body is destroyed with the entity, at the start of the next step.
+ * Track Pose with interpolation::track<physics::Pose>() to draw it smoothly.
+ */
+BodyId add_body(Entity e, const BodyDef& def);
+void remove_body(Entity e);
+
+vec2 position(const World* w, BodyId id);
+float angle(const World* w, BodyId id);
+vec2 velocity(const World* w, BodyId id);
+float angular_velocity(const World* w, BodyId id);
+bool is_awake(const World* w, BodyId id);
+
+// These wake the body's island
+void set_transform(World* w, BodyId id, vec2 position, float angle);
+void set_velocity(World* w, BodyId id, vec2 velocity, float angular_velocity = 0.f);
+void apply_force(World* w, BodyId id, vec2 force);
+void apply_torque(World* w, BodyId id, float torque);
+void apply_impulse(World* w, BodyId id, vec2 impulse, vec2 point);
+void wake(World* w, BodyId id);
+
+// Scene queries, against the broadphase grid. The mask is tested against each body's category.
+struct QueryHit
+{
+    BodyId body;
+    entt::entity owner = entt::null;
+    float fraction = 1.f;
+    vec2 point{0.f};
+    vec2 normal{0.f};
+};
+
+// Nearest body the segment from origin to origin + translation enters
+bool ray_cast(const World* w, vec2 origin, vec2 translation, QueryHit& out, std::uint32_t mask = ~0u);
+// Nearest body the shape touches moving by translation; fraction 0 when it starts out touching one
+bool shape_cast(const World* w, const Shape& shape, vec2 position, float angle, vec2 translation, QueryHit& out,
+                std::uint32_t mask = ~0u);
+bool circle_cast(const World* w, vec2 centre, float radius, vec2 translation, QueryHit& out, std::uint32_t mask = ~0u);
+// Bodies whose bounding box overlaps the box, appended to out
+void query_aabb(const World* w, const AABB& box, std::vector<BodyId>& out, std::uint32_t mask = ~0u);
+
+// The same against the ECS's world; no world, no hits
+bool ray_cast(ECS& ecs, vec2 origin, vec2 translation, QueryHit& out, std::uint32_t mask = ~0u);
+bool shape_cast(ECS& ecs, const Shape& shape, vec2 position, float angle, vec2 translation, QueryHit& out,
+                std::uint32_t mask = ~0u);
+bool circle_cast(ECS& ecs, vec2 centre, float radius, vec2 translation, QueryHit& out, std::uint32_t mask = ~0u);
+void query_aabb(ECS& ecs, const AABB& box, std::vector<BodyId>& out, std::uint32_t mask = ~0u);
+
+void step(World* w, float dt, ECS* ecs = nullptr);
+// Steps the ECS's world if it has one; called by the engine every fixed step
+void step(ECS& ecs, float dt);
+
+}  // namespace kine::physics
@@ -0,0 +1,138 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+
+#include "kine/math.hpp"
+
+namespace kine::physics
+{
+
+inline constexpr int MAX_POLYGON_VERTICES = 8;
+
+struct AABB
+{
+    vec2 min{0.f};
+    vec2 max{0.f};
+};
+
+inline bool overlaps(const AABB& a, const AABB& b)
+{
+    return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y;
+}
+
+struct Rotation
+{
+    float c = 1.f;
+    float s = 0.f;
+};
+
+inline Rotation rotation(float angle) { return {std::cos(angle), std::sin(angle)}; }
+inline vec2 rotate(Rotation r, vec2 v) { return {r.c * v.x - r.s * v.y, r.s * v.x + r.c * v.y}; }
+inline vec2 unrotate(Rotation r, vec2 v) { return {r.c * v.x + r.s * v.y, -r.s * v.x + r.c * v.y}; }
+inline float cross(vec2 a, vec2 b) { return a.x * b.y - a.y * b.x; }
+inline vec2 cross(float w, vec2 v) { return {-w * v.y, w * v.x}; }
+
+enum class ShapeType : std::uint8_t
+{
+    Circle,
+    Polygon
+};
+
+/**
+ * @brief Convex collision shape in body space, centred on the body's centre of mass.
+ *
+ * Polygon vertices wind so that cross(edge, next edge) > 0, which puts the
+ * edge normals on the outside. Use circle(), box() and polygon() to build one.
+ */
+struct Shape
+{
+    ShapeType type = ShapeType::Polygon;
+    float radius = 0.f;
+    int count = 0;
+    std::array<vec2, MAX_POLYGON_VERTICES> vertices{};
+    std::array<vec2, MAX_POLYGON_VERTICES> normals{};
+};
+
+Shape circle(float radius);
+// With BodyDef::fixed_rotation this is an AABB collider
+Shape box(vec2 half_extents);
+// Convex hull of the points, recentred on its centroid
+Shape polygon(std::span<const vec2> points);
+
+struct MassData
+{
+    float mass = 0.f;
+    float inertia = 0.f;  // About the centroid
+};
+
+MassData compute_mass(const Shape& shape, float density);
+AABB compute_aabb(const Shape& shape, vec2 position, Rotation r);
+// Distance from the centroid to the nearest edge, and to the farthest vertex
+float min_extent(const Shape& shape);
+float max_extent(const Shape& shape);
+
+struct ManifoldPoint
+{
+    vec2 point{0.f};       // World space, midway between the surfaces
+    float separation = 0;  // Negative when overlapping
+    std::uint32_t id = 0;  // Features that made the point, for matching across steps
+};
+
+struct Manifold
+{
+    vec2 normal{0.f};  // From A to B
+    std::array<ManifoldPoint, 2> points{};
+    int count = 0;
+};
+
+/**
+ * @brief Contact points between two shapes, up to margin apart.
+ *
+ * A positive margin reports near misses too, which the solver treats as
+ * speculative contacts.
+ */
+Manifold collide(const Shape& a, vec2 pa, Rotation ra, const Shape& b, vec2 pb, Rotation rb, float margin);
+
+/**
+ * @brief Lower bound on the gap between two shapes, negative when they overlap.
+ *
+ * Exact for circles and face to face; corner to corner it can read up to
+ * about 30% short, which only ever makes a time of impact early.
+ */
+float separation(const Shape& a, vec2 pa, Rotation ra, const Shape& b, vec2 pb, Rotation rb);
+
+struct CastHit
+{
+    bool hit = false;
+    float fraction = 1.f;  // Of the translation or sweep; 0 when it starts out touching
+    vec2 point{0.f};
+    vec2 normal{0.f};  // Of the surface hit, facing the caster
+};
+
+// Rays start at origin and end at origin + translation. Rays starting inside a shape miss it.
+CastHit ray_cast(const AABB& box, vec2 origin, vec2 translation);
+CastHit ray_cast(const Shape& shape, vec2 position, Rotation r, vec2 origin, vec2 translation);
+
+// First contact of a box moving by translation with a still one
+CastHit sweep_aabb(const AABB& moving, vec2 translation, const AABB& target);
+
+// Straight line motion from one pose to another over a fraction 0 to 1
+struct Sweep
+{
+    vec2 p0{0.f}, p1{0.f};
+    float a0 = 0.f, a1 = 0.f;
+};
+
+/**
+ * @brief First fraction of two sweeps at which the shapes come within target of each other.
+ *
+ * Conservative advancement: never steps past the impact, and stops within a
+ * tenth of a world unit above target. If it runs out of iterations before
+ * getting that close, it reports a miss whose fraction is how far the sweeps
+ * are known to be clear.
+ */
+CastHit time_of_impact(const Shape& a, const Sweep& sa, const Shape& b, const Sweep& sb, float target);
+
+}  // namespace kine::physics
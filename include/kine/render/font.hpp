@@ -20,4 +20,6 @@ struct Font
     float line_height;
     float ascent;
 };
+
+using FontHandle = Handle<Font>;
 }  // namespace kine
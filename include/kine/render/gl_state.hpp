@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "kine/GL.hpp"
+
+namespace kine
+{
+
+/**
+ * @brief Shadow of the GL bindings the renderer touches.
+ *
+ * Every setter compares against the last value it issued and skips the GL
+ * call when nothing changed. Code outside the renderer binds textures for
+ * uploads and resizes the viewport, so invalidate() forgets those at the
+ * start of each frame.
+ */
+struct GLState
+{
+    static constexpr GLuint UNKNOWN = ~0u;
+    static constexpr std::size_t TEXTURE_UNITS = 8;
+
+    GLuint program = UNKNOWN;
+    GLuint vao = UNKNOWN;
+    GLuint array_buffer = UNKNOWN;
+    GLuint framebuffer = UNKNOWN;
+
+    GLenum active_unit = 0;  // 0 = unknown, otherwise GL_TEXTURE0 + n
+    std::array<GLuint, TEXTURE_UNITS> textures;
+
+    int8_t blend = -1;  // -1 = unknown
+    int8_t depth_test = -1;
+    GLenum blend_src = 0;
+    GLenum blend_dst = 0;
+
+    std::array<GLint, 4> viewport{-1, -1, -1, -1};
+
+    std::size_t issued = 0;
+    std::size_t skipped = 0;
+
+    GLState() { textures.fill(UNKNOWN); }
+};
+
+namespace gl_state
+{
+    // Forget everything; the next call of each setter always reaches GL
+    void reset(GLState* s);
+
+    // Forget the state other modules change behind the renderer's back
+    void invalidate(GLState* s);
+
+    void use_program(GLState* s, GLuint program);
+    void bind_vertex_array(GLState* s, GLuint vao);
+    void bind_array_buffer(GLState* s, GLuint buffer);
+    void bind_framebuffer(GLState* s, GLuint fbo);
+
+    // Bind a GL_TEXTURE_2D to the given unit, switching the active unit only if needed
+    void bind_texture(GLState* s, uint32_t unit, GLuint texture);
+
+    void set_blend(GLState* s, bool enabled);
+    void set_depth_test(GLState* s, bool enabled);
+    void blend_func(GLState* s, GLenum src, GLenum dst);
+    void viewport(GLState* s, GLint x, GLint y, GLint width, GLint height);
+
+    // Deleting a bound texture reverts its bindings to 0 in GL; mirror that here
+    void forget_texture(GLState* s, GLuint texture);
+}  // namespace gl_state
+}  // namespace kine
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gl_state.hpp"
+#include "kine/math.hpp"
+#include "kine/resources/shader_manager.hpp"
+#include "texture2d.hpp"
+
+namespace kine
+{
+
+struct EmitterConfig
+{
+    vec2 position{0.f};
+    float spawn_radius = 0.f;
+
+    float rate = 100.f;             // Particles per second; 0 for bursts only
+    float direction = -1.5707964f;  // Radians, y down: straight up
+    float spread = 3.1415927f;      // Half-angle around direction
+    float speed_min = 50.f;
+    float speed_max = 100.f;
+    float lifetime_min = 1.f;
+    float lifetime_max = 2.f;
+
+    vec2 gravity{0.f};
+    float drag = 0.f;  // Fraction of velocity lost per second
+
+    float size_start = 4.f;
+    float size_end = 0.f;
+    vec4 color_start{1.f};  // 0..1
+    vec4 color_end{1.f, 1.f, 1.f, 0.f};
+
+    TextureHandle texture;  // Null draws a soft disc
+    bool additive = false;
+
+    std::uint32_t max_particles = 10'000;
+};
+
+/**
+ * @brief One emitter and its particles, stored as structure of arrays.
+ *
+ * Live particles are packed at the front of each array, so the update
+ * kernel streams through them four at a time and the renderer uploads
+ * x, y and t straight from the arrays. t runs from 0 at birth to 1 at
+ * death; size and colour are interpolated from it on the GPU.
+ */
+struct ParticleEmitter
+{
+    EmitterConfig config;
+
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    std::vector<float> t;
+    std::vector<float> rate;  // 1 / lifetime
+    std::uint32_t count = 0;
+
+    float spawn_carry = 0.f;
+    bool emitting = true;
+    bool releasing = false;  // Slot goes back to the pool once the last particle dies
+
+    std::uint32_t generation = 1;
+    bool live = false;
+};
+
+using EmitterHandle = Handle<ParticleEmitter>;
+
+struct ParticleSystem
+{
+    // Slots are recycled with their arrays, so a new emitter rarely allocates
+    std::vector<ParticleEmitter> emitters;
+    std::vector<std::uint32_t> free_slots;
+
+    std::uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    resource::Shader shader;
+    GLint loc_projection = -1;
+    GLint loc_size = -1;
+    GLint loc_color_start = -1;
+    GLint loc_color_end = -1;
+    GLint loc_textured = -1;
+
+    std::size_t live_particles = 0;
+    std::uint64_t update_ns = 0;  // Last update()
+};
+
+namespace particles
+{
+    void init(ParticleSystem* ps, GLState* gl);
+    void shutdown(ParticleSystem* ps);
+
+    EmitterHandle create_emitter(ParticleSystem* ps, const EmitterConfig& config);
+    // Stops emitting; the slot is reused once the remaining particles have died
+    void destroy_emitter(ParticleSystem* ps, EmitterHandle handle);
+    ParticleEmitter* get(ParticleSystem* ps, EmitterHandle handle);
+
+    void set_position(ParticleSystem* ps, EmitterHandle handle, vec2 position);
+    void set_emitting(ParticleSystem* ps, EmitterHandle handle, bool emitting);
+    void burst(ParticleSystem* ps, EmitterHandle handle, std::uint32_t count);
+
+    // Simulate, retire and spawn; SSE where available, scalar otherwise
+    void update(ParticleSystem* ps, float dt);
+
+    // One instanced draw per emitter, straight from the SoA arrays
+    void draw(ParticleSystem* ps, GLState* gl, const mat4& projection);
+}  // namespace particles
+}  // namespace kine
@@ -0,0 +1,69 @@
+#pragma once
+#include "gl_state.hpp"
+#include "kine/math.hpp"
+#include "kine/resources/shader_manager.hpp"
+#include "render_graph.hpp"
+
+namespace kine
+{
+
+/**
+ * @brief Chained post effects applied to the scene before presenting.
+ *
+ * Toggle the effects and tweak their settings at any time; each enabled
+ * effect adds its passes to the frame's RenderGraph, so disabled ones cost
+ * nothing and intermediate targets are shared between effects.
+ */
+struct PostFx
+{
+    bool bloom = false;
+    float bloom_threshold = 0.75f;  // Luminance where pixels start to glow
+    float bloom_intensity = 0.8f;
+
+    bool color_grading = false;
+    float exposure = 1.f;
+    float contrast = 1.f;
+    float saturation = 1.f;
+    vec4 tint{1.f};
+
+    bool crt = false;
+    float crt_curvature = 0.08f;
+    float crt_scanlines = 0.3f;
+    float crt_vignette = 0.4f;
+
+    resource::Shader bright_shader;
+    resource::Shader blur_shader;
+    resource::Shader bloom_shader;
+    resource::Shader grade_shader;
+    resource::Shader crt_shader;
+
+    // Uniform locations, resolved once in post_fx::init()
+    GLint loc_threshold = -1;
+    GLint loc_direction = -1;
+    GLint loc_intensity = -1;
+    GLint loc_exposure = -1;
+    GLint loc_contrast = -1;
+    GLint loc_saturation = -1;
+    GLint loc_tint = -1;
+    GLint loc_resolution = -1;
+    GLint loc_curvature = -1;
+    GLint loc_scanlines = -1;
+    GLint loc_vignette = -1;
+};
+
+namespace post_fx
+{
+    void init(PostFx* fx, GLState* gl);
+    void shutdown(PostFx* fx);
+
+    bool any(const PostFx* fx);
+
+    /**
+     * @brief Append the enabled effects to the graph.
+     *
+     * @param quad VAO of the fullscreen quad the passes draw
+     * @return The target holding the final image (input if nothing is enabled)
+     */
+    TargetId add_passes(PostFx* fx, RenderGraph* g, GLState* gl, GLuint quad, TargetId input);
+}  // namespace post_fx
+}  // namespace kine
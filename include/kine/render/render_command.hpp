@@ -24,7 +24,7 @@ struct RenderCommand
     std::string text{};
     Font* font{};
 
-    std::string texture_name{};
+    TextureHandle texture{};
 
     float x{0.0f};
     float y{0.0f};
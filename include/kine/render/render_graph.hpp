@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "gl_state.hpp"
+#include "kine/GL.hpp"
+
+namespace kine
+{
+
+// Index of a transient target declared for the current frame
+using TargetId = uint32_t;
+inline constexpr TargetId BACKBUFFER = ~0u;
+
+struct TargetDesc
+{
+    int width = 0;
+    int height = 0;
+    GLenum format = GL_RGBA8;
+    GLenum filter = GL_NEAREST;
+
+    bool operator==(const TargetDesc&) const = default;
+};
+
+// Color texture + framebuffer backing one or more transient targets
+struct RenderTarget
+{
+    TargetDesc desc;
+    GLuint fbo = 0;
+    GLuint color = 0;
+};
+
+struct RenderGraph;
+struct RenderPass;
+using PassFunc = std::function<void(RenderGraph*, const RenderPass&)>;
+
+struct RenderPass
+{
+    std::string name;
+    std::vector<TargetId> reads;
+    TargetId write = BACKBUFFER;
+    PassFunc execute;
+
+    bool culled = false;
+};
+
+/**
+ * @brief Per-frame list of fullscreen passes over transient targets.
+ *
+ * Passes are declared in execution order with the targets they read and the
+ * one they write. compile() culls passes nothing consumes, then maps each
+ * transient target onto a pooled RenderTarget for the span between its first
+ * write and last read, so targets with disjoint lifetimes share memory. The
+ * pool persists across frames; entries the current frame does not need are
+ * deleted, so memory is bounded by the peak number of live targets.
+ */
+struct RenderGraph
+{
+    std::vector<TargetDesc> targets;
+    std::vector<RenderPass> passes;
+
+    // Filled by compile()
+    std::vector<uint32_t> physical;  // Target -> pool index
+    std::vector<RenderTarget> pool;
+
+    int backbuffer_width = 0;
+    int backbuffer_height = 0;
+
+    std::size_t peak_live = 0;
+    std::size_t pool_bytes = 0;
+};
+
+namespace render_graph
+{
+    // Drop last frame's passes and targets; the pool is kept
+    void begin(RenderGraph* g, int backbuffer_width, int backbuffer_height);
+
+    TargetId create_target(RenderGraph* g, const TargetDesc& desc);
+
+    // A pass may not read the target it writes
+    void add_pass(RenderGraph* g, std::string name, std::vector<TargetId> reads, TargetId write, PassFunc execute);
+
+    void compile(RenderGraph* g, GLState* gl);
+
+    // Binds each pass' framebuffer and viewport, then runs it
+    void execute(RenderGraph* g, GLState* gl);
+
+    GLuint texture(const RenderGraph* g, TargetId target);
+    TargetDesc desc(const RenderGraph* g, TargetId target);
+
+    // Delete every pooled target
+    void release(RenderGraph* g, GLState* gl);
+}  // namespace render_graph
+}  // namespace kine
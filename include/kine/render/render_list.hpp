@@ -26,6 +26,8 @@ inline const std::vector<RenderCommand>& get() { return commands; }
 
 inline void clear() { commands.clear(); }
 
+void draw_sprite(TextureHandle texture, vec2 pos, float rotation, vec2 pivot, float scale = 1, int32_t layer = 1);
+// Convenience overload, looks the texture up by name on every call
 void draw_sprite(const std::string& texture_name, vec2 pos, float rotation, vec2 pivot, float scale = 1,
                  int32_t layer = 1);
 
@@ -5,6 +5,10 @@
 #include "kine/GL.hpp"
 #include "kine/math.hpp"
 #include "kine/resources/resource_manager.hpp"
+#include "gl_state.hpp"
+#include "particles.hpp"
+#include "post_fx.hpp"
+#include "render_graph.hpp"
 #include "render_batcher.hpp"
 #include "render_command.hpp"
 #include "render_list.hpp"
@@ -52,9 +56,12 @@ struct Renderer2D
     static constexpr size_t MAX_VERTICES = 100'000;
 
     // OpenGL objects
+    GLState gl;
     GLuint vao = 0;
     GLuint vbo = 0;
-    GLuint shader = 0;
+    resource::Shader shader;
+    GLint loc_projection = -1;
+    GLint loc_aspect = -1;
 
     mat4 projection{1};
 
@@ -64,18 +71,25 @@ struct Renderer2D
     int virtual_width = 0;
     int virtual_height = 0;
 
-    GLuint virtual_fbo = 0;
-    GLuint virtual_color = 0;
-    GLuint virtual_rbo = 0;
-
     ScalingMode scaling_mode = ScalingMode::LetterboxedAuto;
     vec2 final_scale{1};
     vec2 final_offset{0};
 
+    // Offscreen passes, used with virtual resolution or post effects
+    RenderGraph graph;
+    PostFx post;
+
+    // Drawn after the batched scene, bypassing the batcher
+    ParticleSystem particles;
+
     // Blit pass
     GLuint blit_vao = 0;
     GLuint blit_vbo = 0;
-    GLuint blit_shader = 0;
+    resource::Shader blit_shader;
+    GLint loc_final_scale = -1;
+    GLint loc_final_offset = -1;
+    GLint loc_window_size = -1;
+    GLint loc_virtual_size = -1;
 };
 
 namespace renderer2d
@@ -100,7 +114,7 @@ namespace renderer2d
 
     void draw_batches(Renderer2D* r);
     void draw_batches_direct(Renderer2D* r);
-    void draw_batches_virtual(Renderer2D* r);
+    void draw_batches_offscreen(Renderer2D* r);
 
     void create_gl_objects(Renderer2D* r);
     void destroy_gl_objects(Renderer2D* r);
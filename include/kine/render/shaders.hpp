@@ -130,4 +130,177 @@ void main()
     FragColor = texture(uTexture, vUV);
 }
 )";
+
+// Fullscreen pass over the blit quad, no scaling
+inline static std::string post_vert = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aUV;
+
+out vec2 vUV;
+
+void main()
+{
+    vUV = aUV;
+    gl_Position = vec4(aPos, 0.0, 1.0);
+}
+)";
+
+inline static std::string bright_frag = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uTexture;
+uniform float uThreshold;
+
+void main()
+{
+    vec3 c = texture(uTexture, vUV).rgb;
+    float l = dot(c, vec3(0.2126, 0.7152, 0.0722));
+    FragColor = vec4(c * smoothstep(uThreshold, uThreshold + 0.1, l), 1.0);
+}
+)";
+
+// 9-tap gaussian folded into 5 bilinear taps; uDirection is one texel along the blur axis
+inline static std::string blur_frag = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uTexture;
+uniform vec2 uDirection;
+
+void main()
+{
+    vec2 o1 = uDirection * 1.3846153846;
+    vec2 o2 = uDirection * 3.2307692308;
+
+    vec3 c = texture(uTexture, vUV).rgb * 0.2270270270;
+    c += (texture(uTexture, vUV + o1).rgb + texture(uTexture, vUV - o1).rgb) * 0.3162162162;
+    c += (texture(uTexture, vUV + o2).rgb + texture(uTexture, vUV - o2).rgb) * 0.0702702703;
+    FragColor = vec4(c, 1.0);
+}
+)";
+
+inline static std::string bloom_frag = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uTexture;
+uniform sampler2D uBloom;
+uniform float uIntensity;
+
+void main()
+{
+    vec4 scene = texture(uTexture, vUV);
+    FragColor = vec4(scene.rgb + texture(uBloom, vUV).rgb * uIntensity, scene.a);
+}
+)";
+
+inline static std::string grade_frag = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uTexture;
+uniform float uExposure;
+uniform float uContrast;
+uniform float uSaturation;
+uniform vec4 uTint;
+
+void main()
+{
+    vec4 src = texture(uTexture, vUV);
+    vec3 c = src.rgb * uExposure * uTint.rgb;
+    c = (c - 0.5) * uContrast + 0.5;
+    c = mix(vec3(dot(c, vec3(0.2126, 0.7152, 0.0722))), c, uSaturation);
+    FragColor = vec4(clamp(c, 0.0, 1.0), src.a);
+}
+)";
+
+inline static std::string crt_frag = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uTexture;
+uniform vec2 uResolution;
+uniform float uCurvature;
+uniform float uScanlines;
+uniform float uVignette;
+
+void main()
+{
+    vec2 uv = vUV * 2.0 - 1.0;
+    uv += uv * (uv.yx * uv.yx) * uCurvature;
+    uv = uv * 0.5 + 0.5;
+
+    if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0))))
+    {
+        FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    vec3 c = texture(uTexture, uv).rgb;
+    c *= mix(1.0, 0.5 + 0.5 * sin(uv.y * uResolution.y * 3.14159265), uScanlines);
+
+    float vignette = 16.0 * uv.x * uv.y * (1.0 - uv.x) * (1.0 - uv.y);
+    c *= mix(1.0, pow(vignette, 0.25), uVignette);
+
+    FragColor = vec4(c, 1.0);
+}
+)";
+
+// Particles: one instance per particle, the quad's corners come from gl_VertexID
+inline static std::string particle_vert = R"(
+#version 330 core
+
+layout(location = 0) in float aX;
+layout(location = 1) in float aY;
+layout(location = 2) in float aT;
+
+uniform mat4 uProjection;
+uniform vec2 uSize;  // At birth, at death
+uniform vec4 uColorStart;
+uniform vec4 uColorEnd;
+
+out vec2 vUV;
+out vec4 vColor;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    float size = mix(uSize.x, uSize.y, aT);
+
+    vUV = corner;
+    vColor = mix(uColorStart, uColorEnd, aT);
+    gl_Position = uProjection * vec4(vec2(aX, aY) + (corner - 0.5) * size, 0.0, 1.0);
+}
+)";
+
+inline static std::string particle_frag = R"(
+#version 330 core
+
+in vec2 vUV;
+in vec4 vColor;
+
+out vec4 FragColor;
+
+uniform sampler2D uTexture;
+uniform int uTextured;
+
+void main()
+{
+    if (uTextured == 1)
+    {
+        FragColor = texture(uTexture, vUV) * vColor;
+        return;
+    }
+
+    float d = length(vUV - 0.5) * 2.0;
+    FragColor = vec4(vColor.rgb, vColor.a * (1.0 - smoothstep(0.5, 1.0, d)));
+}
+)";
 }  // namespace kine::renderer2d
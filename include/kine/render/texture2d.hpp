@@ -1,7 +1,11 @@
 #pragma once
 #include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
+#include "kine/resources/resource_pool.hpp"
+
 namespace kine
 {
 
@@ -11,6 +15,15 @@ struct Texture2D
     int width = 0;
     int height = 0;
     std::string name;
+    bool ready = true;  // False while an async load still shows the error texture
+
+    // Residency bookkeeping, see resource::residency
+    std::size_t gpu_bytes = 0;    // Estimated, all mip levels
+    std::uint64_t last_used = 0;  // Frame it was last drawn in
+    bool evicted = false;         // GPU copy dropped, reloads on next use
+    bool pinned = false;          // Handed out by get_texture(), so its id may be held anywhere; never evicted
 };
 
+using TextureHandle = Handle<Texture2D>;
+
 }  // namespace kine
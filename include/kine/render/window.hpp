@@ -6,6 +6,9 @@ namespace kine::window
 
 inline GLFWwindow* window;
 
+// Read by create(): hidden window and no vsync, for benchmarks and CI replays
+inline bool headless = false;
+
 void create(int width, int height, const char* title);
 
 inline GLFWwindow* get() { return window; }
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "kine/resources/texture_manager.hpp"
+
+namespace kine::resource
+{
+
+using TextureCallback = std::function<void(Texture2D&)>;
+
+/**
+ * @brief Background texture loading.
+ *
+ * A pool of worker threads decodes and cooks images (see texture_cache) and hands them
+ * to a bounded upload queue. pump() drains that queue on the GL thread,
+ * spending at most upload_budget_ms per frame, so a level load never stalls
+ * a frame on decode or on a burst of uploads.
+ */
+namespace async
+{
+    // Decoded images waiting for upload; workers block when it is full
+    inline std::size_t upload_capacity = 16;
+    // GL-thread time spent uploading per pump()
+    inline float upload_budget_ms = 2.0f;
+
+    void init(unsigned workers = 0);  // 0 = hardware threads - 1
+    void shutdown();
+
+    // Upload decoded textures and run their callbacks. Call on the GL thread.
+    void pump();
+
+    // Textures requested but not yet uploaded
+    std::size_t pending();
+    // Block until every queued texture is uploaded
+    void wait_all();
+
+    // Load a registered texture's file again into its existing slot (used for evicted textures)
+    void requeue(TextureHandle handle);
+}  // namespace async
+
+/**
+ * @brief Queue a texture for background loading.
+ *
+ * Returns immediately with a handle whose texture shows the error texture
+ * (ready == false) until the upload lands and fills it in place. on_ready
+ * runs on the GL thread once the texture is usable, or right away if it
+ * already is.
+ */
+TextureHandle load_texture_async(const std::string& name, const std::string& file, TextureCallback on_ready = {});
+
+}  // namespace kine::resource
@@ -4,6 +4,8 @@
 #include <unordered_map>
 
 #include "kine/render/font.hpp"
+#include "kine/resources/resource_pool.hpp"
+#include "kine/resources/texture_manager.hpp"
 
 #include "ft2build.h"
 #include FT_FREETYPE_H
@@ -12,11 +14,32 @@ namespace kine::resource
 {
 
 inline FT_Library library;
-inline std::unordered_map<std::string, Font> fonts;
+inline ResourcePool<Font> fonts;
 
-Font& load_font(const std::string& name, const std::string& file, int pixel_height);
+struct FontSource
+{
+    std::string file;
+    int pixel_height = 0;
+    TextureHandle atlas;
+};
+
+// What each loaded font was built from, for reload_font()
+inline std::unordered_map<std::string, FontSource> font_sources;
+
+// Load a font, or take another reference to it if name is already loaded
+FontHandle load_font(const std::string& name, const std::string& file, int pixel_height);
+FontHandle find_font(const std::string& name);
+
+Font& get_font(FontHandle handle);
+// Convenience lookup by name, hashes the name on every call
 Font& get_font(const std::string& name);
 
+// Drop one reference; the font and its atlas are freed with the last one
+void unload_font(FontHandle handle);
+
+// Re-read the font's file and rebuild its glyphs and atlas in place
+bool reload_font(const std::string& name);
+
 Font load_font_file(const std::string& name, const std::string& path);
 
 }  // namespace kine::resource
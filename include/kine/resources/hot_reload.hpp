@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * @brief Reload assets when their files change on disk.
+ *
+ * Watches every directory under the search dirs (inotify on Linux, a no-op
+ * elsewhere). poll() picks up changes, updates file_index for added, moved
+ * and deleted files, and reloads the textures, shaders and fonts built from
+ * a changed file in place: Texture2D&, Font& and program ids stay valid.
+ * Mounted packs are never watched.
+ */
+namespace kine::resource::hot_reload
+{
+
+#ifndef NDEBUG
+inline bool enabled = true;
+#else
+inline bool enabled = false;
+#endif
+
+void start();
+void stop();
+
+// Apply pending file changes. Call on the GL thread.
+void poll();
+
+}  // namespace kine::resource::hot_reload
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Packed asset archive.
+ *
+ * Layout: Header, then Entry[entry_count] sorted by name hash, then the
+ * name blob, then the file data. A pack is memory-mapped whole, so opening
+ * one is O(1) and lookups are a binary search over the mapped entry table;
+ * uncompressed entries are handed out as views into the mapping.
+ */
+namespace kine::pack
+{
+
+inline constexpr std::uint32_t MAGIC = 0x4B41504B;  // "KPAK"
+inline constexpr std::uint32_t VERSION = 1;
+inline constexpr std::size_t DATA_ALIGN = 16;
+
+enum class Compression : std::uint32_t
+{
+    None = 0,
+    Brotli = 1,
+};
+
+struct Header
+{
+    std::uint32_t magic = MAGIC;
+    std::uint32_t version = VERSION;
+    std::uint32_t entry_count = 0;
+    std::uint32_t names_size = 0;
+    std::uint64_t entries_offset = 0;
+    std::uint64_t names_offset = 0;
+};
+
+struct Entry
+{
+    std::uint64_t hash = 0;
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;      // Stored bytes
+    std::uint64_t raw_size = 0;  // Decoded bytes, 0 if unknown
+    std::uint32_t name_offset = 0;
+    std::uint32_t name_size = 0;
+    Compression compression = Compression::None;
+    std::uint32_t reserved = 0;
+};
+
+static_assert(sizeof(Header) == 32);
+static_assert(sizeof(Entry) == 48);
+
+// FNV-1a, 64 bit
+constexpr std::uint64_t hash(std::string_view s)
+{
+    std::uint64_t h = 14695981039346656037ull;
+    for (char c : s)
+    {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Read-only mapping of a whole file
+struct MappedFile
+{
+    const std::byte* data = nullptr;
+    std::size_t size = 0;
+
+#if defined(_WIN32)
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+bool map_file(MappedFile* f, const std::string& path);
+void unmap_file(MappedFile* f);
+
+struct Pack
+{
+    std::string path;
+    MappedFile file;
+
+    const Header* header = nullptr;
+    const Entry* entries = nullptr;
+    const char* names = nullptr;
+
+    // Decoded copies of compressed entries, by name hash
+    std::unordered_map<std::uint64_t, std::vector<std::byte>> decoded;
+};
+
+// Map a pack file. Returns false (and leaves p closed) if it is missing or malformed.
+bool open(Pack* p, const std::string& path);
+void close(Pack* p);
+
+const Entry* find(const Pack* p, std::string_view name);
+std::string_view entry_name(const Pack* p, const Entry& e);
+
+/**
+ * @brief Bytes of an entry, empty if it is not in the pack.
+ *
+ * Uncompressed entries are views into the mapping. Compressed ones are
+ * decoded on first access and cached in the pack. Not thread-safe; the
+ * returned view stays valid until close().
+ */
+std::span<const std::byte> read(Pack* p, std::string_view name);
+
+struct Source
+{
+    std::string name;  // Key the entry is looked up by
+    std::string path;  // File on disk holding the stored bytes
+    Compression compression = Compression::None;
+};
+
+// Write a pack from files on disk (used by the kine_pack tool)
+bool write(const std::string& path, std::vector<Source> sources);
+
+}  // namespace kine::pack
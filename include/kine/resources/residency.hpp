@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "kine/render/texture2d.hpp"
+
+/**
+ * @brief Texture memory budget.
+ *
+ * Every upload is accounted (all mip levels), and the renderer stamps the
+ * frame a texture was last drawn in. update() evicts file-backed textures
+ * that have gone unused for evict_after_frames, and while the resident set
+ * is over budget_bytes it also evicts the least recently used ones not drawn
+ * this frame. Textures pinned by get_texture() are never evicted. An evicted texture keeps its handle and shows the error
+ * texture until use() sees it again and reloads it through the async loader.
+ */
+namespace kine::resource::residency
+{
+
+inline std::size_t budget_bytes = std::size_t(512) << 20;
+inline std::uint32_t evict_after_frames = 600;
+
+struct Stats
+{
+    std::size_t budget_bytes = 0;
+    std::size_t resident_bytes = 0;
+    std::size_t resident_count = 0;
+    std::size_t evicted_count = 0;  // Currently evicted
+    std::size_t evictions = 0;      // Since start
+    std::size_t reloads = 0;        // Since start
+};
+
+// Texture for drawing: stamps its last use and requeues it if it was evicted
+Texture2D& use(TextureHandle handle);
+
+// Record tex's new GPU footprint (bytes 0 once its storage is deleted)
+void account(Texture2D& tex, std::size_t bytes);
+
+// Advance the frame and evict; called once per frame after rendering
+void update();
+
+void reset();
+
+Stats stats();
+std::uint64_t frame();
+
+}  // namespace kine::resource::residency
@@ -1,11 +1,19 @@
 #pragma once
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "async_loader.hpp"
 #include "font_manager.hpp"
+#include "hot_reload.hpp"
+#include "residency.hpp"
 #include "kine/log.hpp"
 #include "kine/resources/texture_manager.hpp"
+#include "pack.hpp"
 #include "shader_manager.hpp"
 
 namespace kine::resource
@@ -15,9 +23,29 @@ inline std::vector<std::string> search_dirs;
 inline std::vector<std::string> extensions;
 
 inline std::unordered_map<std::string, std::string> file_index;
+// Where build() persists file_index, relative to the executable; empty disables it
+inline std::string index_cache = ".cache/index.bin";
+
+// Mounted packs, searched newest first and before file_index
+inline std::deque<pack::Pack> packs;
+// Mounted from next to the executable by init(); when found the directory scan is skipped
+inline std::string default_pack = "assets.kpak";
+
+/**
+ * @brief Bytes of an asset.
+ *
+ * A view into a mounted pack (no copy), or the contents of a loose file held
+ * in storage.
+ */
+struct AssetData
+{
+    std::span<const std::byte> bytes;
+    std::vector<std::byte> storage;
+};
 
 void create();
 void init();
+// Index search_dirs: reuse the cached index if no indexed directory changed, else walk them in parallel
 void build();
 void shutdown();
 
@@ -30,7 +58,17 @@ inline void add_search(std::vector<std::string> dirs, std::vector<std::string> e
     extensions.insert(extensions.end(), ext.begin(), ext.end());
 }
 
+std::filesystem::path get_executable_dir();
+
 const std::string& get_path(const std::string& name);
 const std::string read_file(const std::string& path);
 
+bool mount(const std::string& path);
+bool exists(const std::string& name);
+
+// View of a packed asset, empty if no mounted pack has it
+std::span<const std::byte> find_packed(const std::string& name);
+// Packed view if mounted, otherwise the indexed loose file read into memory
+AssetData read_asset(const std::string& name);
+
 }  // namespace kine::resource
@@ -0,0 +1,177 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kine
+{
+
+/**
+ * @brief Generational reference to a resource in a ResourcePool.
+ *
+ * Stays cheap to copy and compare, and resolves to nothing once the slot it
+ * points at is unloaded and reused. A default-constructed handle is null.
+ */
+template <typename T>
+struct Handle
+{
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0;
+
+    bool valid() const { return generation != 0; }
+    explicit operator bool() const { return valid(); }
+    bool operator==(const Handle&) const = default;
+};
+
+/**
+ * @brief Slot array of named, refcounted resources.
+ *
+ * Handle lookup is an index plus a generation check. Slots live in a deque,
+ * so a T& stays valid until that resource is removed, no matter how many
+ * others are added. Names are only consulted through find().
+ */
+template <typename T>
+class ResourcePool
+{
+   public:
+    using HandleType = Handle<T>;
+
+    HandleType insert(const std::string& name, T&& value)
+    {
+        std::uint32_t index;
+        if (!free_slots.empty())
+        {
+            index = free_slots.back();
+            free_slots.pop_back();
+        }
+        else
+        {
+            index = static_cast<std::uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+
+        Slot& slot = slots[index];
+        slot.value = std::move(value);
+        slot.name = name;
+        slot.refs = 1;
+        slot.live = true;
+
+        by_name[name] = index;
+        ++live_count;
+        return {index, slot.generation};
+    }
+
+    T* get(HandleType h)
+    {
+        Slot* slot = resolve(h);
+        return slot ? &slot->value : nullptr;
+    }
+
+    const T* get(HandleType h) const { return const_cast<ResourcePool*>(this)->get(h); }
+
+    bool contains(HandleType h) const { return get(h) != nullptr; }
+
+    HandleType find(const std::string& name) const
+    {
+        auto it = by_name.find(name);
+        if (it == by_name.end()) return {};
+        return {it->second, slots[it->second].generation};
+    }
+
+    const std::string& name(HandleType h) const
+    {
+        static const std::string empty;
+        const Slot* slot = const_cast<ResourcePool*>(this)->resolve(h);
+        return slot ? slot->name : empty;
+    }
+
+    void acquire(HandleType h)
+    {
+        if (Slot* slot = resolve(h)) ++slot->refs;
+    }
+
+    // Drop one reference, returns how many are left
+    std::uint32_t release(HandleType h)
+    {
+        Slot* slot = resolve(h);
+        if (!slot || slot->refs == 0) return 0;
+        return --slot->refs;
+    }
+
+    std::uint32_t refs(HandleType h) const
+    {
+        const Slot* slot = const_cast<ResourcePool*>(this)->resolve(h);
+        return slot ? slot->refs : 0;
+    }
+
+    // Take the resource out of find() while its handles stay valid, so its name can be loaded again
+    void forget(HandleType h)
+    {
+        Slot* slot = resolve(h);
+        if (!slot) return;
+
+        auto it = by_name.find(slot->name);
+        if (it != by_name.end() && it->second == h.index) by_name.erase(it);
+    }
+
+    // Free the slot regardless of its refcount; outstanding handles go stale
+    void erase(HandleType h)
+    {
+        Slot* slot = resolve(h);
+        if (!slot) return;
+
+        forget(h);
+        slot->value = T{};
+        slot->name.clear();
+        slot->refs = 0;
+        slot->live = false;
+        if (++slot->generation == 0) slot->generation = 1;
+
+        free_slots.push_back(h.index);
+        --live_count;
+    }
+
+    template <typename Fn>
+    void each(Fn&& fn)
+    {
+        for (std::uint32_t i = 0; i < slots.size(); ++i)
+            if (slots[i].live) fn(HandleType{i, slots[i].generation}, slots[i].value);
+    }
+
+    void clear()
+    {
+        slots.clear();
+        free_slots.clear();
+        by_name.clear();
+        live_count = 0;
+    }
+
+    std::size_t size() const { return live_count; }
+
+   private:
+    struct Slot
+    {
+        T value{};
+        std::string name;
+        std::uint32_t generation = 1;
+        std::uint32_t refs = 0;
+        bool live = false;
+    };
+
+    std::deque<Slot> slots;
+    std::vector<std::uint32_t> free_slots;
+    std::unordered_map<std::string, std::uint32_t> by_name;
+    std::size_t live_count = 0;
+
+    Slot* resolve(HandleType h)
+    {
+        if (h.index >= slots.size()) return nullptr;
+        Slot& slot = slots[h.index];
+        return slot.live && slot.generation == h.generation ? &slot : nullptr;
+    }
+};
+
+}  // namespace kine
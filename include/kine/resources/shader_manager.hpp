@@ -1,22 +1,95 @@
 #pragma once
 #include <glad/glad.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include "kine/math.hpp"
+#include "kine/resources/resource_pool.hpp"
 
 namespace kine::resource
 {
 
+// Last value uploaded to a uniform location, up to a mat4
+struct UniformValue
+{
+    std::array<std::byte, sizeof(mat4)> data{};
+    std::uint8_t size = 0;  // 0 = nothing uploaded yet
+};
+
+/**
+ * @brief Linked program with its uniforms reflected at link time.
+ *
+ * set_uniform() compares against the last uploaded value and skips the GL
+ * call when nothing changed. Values are tracked per program, so the program
+ * must be bound when setting them, as with glUniform*.
+ */
 struct Shader
 {
     GLuint program = 0;
+
+    std::unordered_map<std::string, GLint> locations;  // Active uniform name -> location
+    std::vector<UniformValue> values;                  // Indexed by location
+
+    std::size_t uploads = 0;
+    std::size_t skipped = 0;
 };
 
+using ShaderHandle = Handle<Shader>;
+
+// Where linked program binaries are kept; set next to the executable by resource::init(), empty disables
+inline std::string program_cache_dir;
+
 GLuint compile_shader(GLenum type, const std::string& source);
 
-inline std::unordered_map<std::string, Shader> shaders;
+/**
+ * @brief Build a program from GLSL sources.
+ *
+ * Tries the program binary cached under the sources' hash first, otherwise
+ * compiles, links (throwing std::runtime_error with the info log on failure)
+ * and stores the binary for next time.
+ */
+Shader build_shader(const std::string& vert, const std::string& frag);
+
+// Re-read the program's active uniforms and forget tracked values (after a relink)
+void reflect_uniforms(Shader& shader);
+
+GLint uniform_location(const Shader& shader, const std::string& name);
 
+void set_uniform(Shader& shader, GLint location, int value);
+void set_uniform(Shader& shader, GLint location, float value);
+void set_uniform(Shader& shader, GLint location, vec2 value);
+void set_uniform(Shader& shader, GLint location, vec4 value);
+void set_uniform(Shader& shader, GLint location, const mat4& value);
+
+inline ResourcePool<Shader> shaders;
+
+struct ShaderSource
+{
+    std::string vertex;
+    std::string fragment;
+};
+
+// What each loaded shader was built from, for reload_shader()
+inline std::unordered_map<std::string, ShaderSource> shader_sources;
+
+// Program id only; prefer build_shader() to keep the uniform cache
 GLuint load_shader_str(const std::string& vert, const std::string& frag);
-Shader& load_shader(const std::string& name, const std::string& vertex, const std::string& fragment);
+// Load a shader, or take another reference to it if name is already loaded
+ShaderHandle load_shader(const std::string& name, const std::string& vertex, const std::string& fragment);
+ShaderHandle find_shader(const std::string& name);
+
+Shader& get_shader(ShaderHandle handle);
+// Convenience lookup by name, hashes the name on every call
 Shader& get_shader(const std::string& name);
 
+// Drop one reference; the program is deleted with the last one
+void unload_shader(ShaderHandle handle);
+
+// Recompile and relink the shader's sources into its existing program; keeps the old one on error
+bool reload_shader(const std::string& name);
+
 }  // namespace kine::resource
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Cooked texture cache.
+ *
+ * The first load of an image decodes it, builds the full mip chain on the
+ * CPU and writes the result to <dir>/<source hash>.ktex. Later loads of the
+ * same bytes read that file back and upload each level directly, skipping
+ * both the PNG/JPG decode and glGenerateMipmap. Editing a source changes its
+ * hash, so stale entries are simply never hit again.
+ */
+namespace kine::resource::texture_cache
+{
+
+inline constexpr std::uint32_t MAGIC = 0x5845544B;  // "KTEX"
+inline constexpr std::uint32_t VERSION = 1;
+
+inline bool enabled = true;
+// Defaults to .cache/textures next to the executable, set by resource::init()
+inline std::string dir;
+
+struct Level
+{
+    std::uint64_t offset = 0;  // Into CookedTexture::pixels
+    std::uint64_t size = 0;
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+};
+
+/**
+ * @brief Decoded, mip-chained pixels ready for glTexImage2D.
+ *
+ * Rows are tightly packed (GL_UNPACK_ALIGNMENT 1).
+ */
+struct CookedTexture
+{
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+    std::int32_t channels = 0;
+    std::vector<Level> levels;
+    std::vector<std::byte> pixels;
+};
+
+std::uint64_t source_hash(std::span<const std::byte> bytes);
+
+// Build the mip chain for 8-bit pixels with a 2x2 box filter
+CookedTexture cook(const unsigned char* pixels, int width, int height, int channels);
+
+bool load(std::uint64_t hash, CookedTexture& out);
+void store(std::uint64_t hash, const CookedTexture& tex);
+
+/**
+ * @brief Cooked form of an encoded image: from the cache, or decoded, cooked and stored.
+ *
+ * Thread-safe; used by both the synchronous and the async texture loaders.
+ */
+bool decode(std::span<const std::byte> bytes, CookedTexture& out);
+
+}  // namespace kine::resource::texture_cache
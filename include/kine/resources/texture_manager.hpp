@@ -1,22 +1,60 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <cstddef>
+#include <span>
 #include <string>
 #include <unordered_map>
 
 #include "kine/render/texture2d.hpp"
+#include "kine/resources/resource_pool.hpp"
+#include "kine/resources/texture_cache.hpp"
 
 namespace kine::resource
 {
 
 inline Texture2D* error_texture = nullptr;
-inline std::unordered_map<std::string, Texture2D> textures;
+inline TextureHandle error_handle;
+inline ResourcePool<Texture2D> textures;
+// Asset key each file-backed texture was loaded from, for reload_texture()
+inline std::unordered_map<std::string, std::string> texture_sources;
 
-Texture2D& load_texture(const std::string& name, const std::string& file);
+/**
+ * @brief Load a texture, or take another reference to it if name is already loaded.
+ *
+ * Returns error_handle if the file cannot be decoded. Names are only looked
+ * at here; keep the handle for drawing.
+ */
+TextureHandle load_texture(const std::string& name, const std::string& file);
+TextureHandle add_texture(const std::string& name, Texture2D&& tex);
+TextureHandle load_embedded_texture(const std::string& name, const unsigned char* buffer, const unsigned int len);
+
+// Handle of an already loaded texture, null if there is none
+TextureHandle find_texture(const std::string& name);
+
+// O(1); the error texture for null or stale handles. Pins the texture: residency never evicts it, since the
+// caller may keep its GL id. Draw through residency::use() instead to keep a texture evictable.
+Texture2D& get_texture(TextureHandle handle);
+// Convenience lookup by name, hashes the name on every call
 Texture2D& get_texture(const std::string& name);
-Texture2D& add_texture(const std::string& name, Texture2D&& tex);
-Texture2D& load_embedded_texture(const std::string& name, const unsigned char* buffer, const unsigned int len);
+// get_texture() without pinning, for residency and code that only looks
+Texture2D& peek_texture(TextureHandle handle);
+
+// Drop one reference; the GL texture is deleted with the last one
+void unload_texture(TextureHandle handle);
+// Delete the texture now, whatever its refcount; outstanding handles go stale
+void destroy_texture(TextureHandle handle);
+
+// Re-read the texture's file and upload it into the same texture id
+bool reload_texture(const std::string& name);
 
 Texture2D load_texture_file(const std::string& name, const std::string& path);
+// Decode and upload without registering; id is 0 on failure
+Texture2D load_texture_memory(const std::string& name, std::span<const std::byte> bytes);
+
+// Upload decoded 8-bit pixels into tex (allocates tex.id if needed) and build mipmaps
+void upload_texture(Texture2D& tex, const unsigned char* pixels, int channels);
+// Upload every level of a cooked texture into tex (allocates tex.id if needed)
+void upload_cooked(Texture2D& tex, const texture_cache::CookedTexture& cooked);
 
 }  // namespace kine::resource
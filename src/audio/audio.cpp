@@ -0,0 +1,774 @@
+#include "kine/audio/audio.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define KINE_AUDIO_SSE 1
+#endif
+
+#include "kine/core/mpsc_queue.hpp"
+#include "kine/log.hpp"
+#include "kine/resources/resource_manager.hpp"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wshadow"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#pragma GCC diagnostic ignored "-Wdouble-promotion"
+#include <miniaudio.h>
+#pragma GCC diagnostic pop
+
+namespace kine::audio
+{
+
+/**
+ * @brief Single-producer single-consumer ring of stereo frames.
+ *
+ * The decode thread writes, the audio callback reads. Positions only grow;
+ * capacity is a power of two so they wrap with a mask.
+ */
+struct StreamRing
+{
+    std::unique_ptr<float[]> samples;
+    std::uint32_t capacity = 0;  // Frames
+    std::atomic<std::uint64_t> write{0};
+    std::atomic<std::uint64_t> read{0};
+};
+
+// Asset decoded into a ring while it plays
+struct Stream
+{
+    pack::MappedFile file;  // Loose files are mapped; packed ones are views into the pack
+    std::span<const std::byte> bytes;
+    ma_decoder decoder;
+    bool decoder_ready = false;
+
+    StreamRing ring;
+    bool loop = false;
+    std::atomic<bool> ended{false};  // Decoder is done; the voice ends when the ring drains
+    std::atomic<bool> orphaned{false};  // Retired while the retired queue was full; update() sweeps for it
+};
+
+enum class CommandType : std::uint8_t
+{
+    Play,
+    Stop,
+    StopAll,
+    StopSound,
+    Pause,
+    Volume,
+    Pan,
+    BusVolume,
+    MasterVolume
+};
+
+struct Command
+{
+    CommandType type = CommandType::Stop;
+    Bus bus = Bus::Sfx;
+    bool flag = false;  // Loop for Play, paused for Pause
+    VoiceId voice = 0;
+    const Sound* sound = nullptr;
+    Stream* stream = nullptr;
+    float value = 0.f;
+    float pan = 0.f;
+};
+
+// Owned by the audio thread once init() returns
+struct Voice
+{
+    VoiceId id = 0;  // 0 = free
+    const Sound* sound = nullptr;
+    Stream* stream = nullptr;
+    std::uint64_t cursor = 0;
+    std::uint64_t started = 0;
+    float volume = 1.f;
+    float pan = 0.f;
+    Bus bus = Bus::Sfx;
+    bool loop = false;
+    bool paused = false;
+};
+
+static constexpr std::uint32_t STREAM_CHUNK = 512;
+static constexpr auto DECODE_INTERVAL = std::chrono::milliseconds(5);
+
+struct PendingUnload
+{
+    SoundHandle handle;
+    const Sound* sound = nullptr;
+    std::uint64_t after = 0;  // Free once this many commands were consumed; 0 = StopSound not queued yet
+};
+
+struct State
+{
+    ma_context context;
+    ma_device device;
+    bool has_device = false;
+    bool initialized = false;
+
+    MpscQueue<Command, COMMAND_CAPACITY> commands;
+    MpscQueue<Stream*, COMMAND_CAPACITY> retired;  // Audio thread -> update()
+    std::atomic<std::uint32_t> orphans{0};         // Retired streams that did not fit in the queue
+
+    std::atomic<std::uint64_t> submitted{0};
+    std::atomic<std::uint64_t> consumed{0};
+    std::atomic<VoiceId> next_voice{1};
+
+    std::vector<PendingUnload> unloads;
+
+    // Decode thread and the streams it keeps topped up
+    std::thread decode_thread;
+    std::mutex streams_mutex;
+    std::condition_variable streams_cv;
+    std::vector<Stream*> streams;
+    bool quit = false;
+
+    // Audio thread only
+    std::array<Voice, MAX_VOICES> voices;
+    std::array<float, std::size_t(Bus::Count)> bus_volume{};
+    float master_volume = 1.f;
+    std::uint64_t play_counter = 0;
+
+    std::atomic<std::uint64_t> callbacks{0};
+    std::atomic<std::uint64_t> frames{0};
+    std::atomic<std::uint32_t> playing{0};
+    std::atomic<std::uint64_t> mix_ns_last{0};
+    std::atomic<std::uint64_t> mix_ns_max{0};
+    std::atomic<std::uint64_t> stolen{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint64_t> underruns{0};
+};
+
+static std::unique_ptr<State> state;
+
+static bool submit(const Command& cmd)
+{
+    if (!state || !state->initialized) return false;
+
+    if (!state->commands.try_push(cmd))
+    {
+        state->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    state->submitted.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+// --- Audio thread ----------------------------------------------------------
+
+// Decoders are freed on the game thread. A full queue must not lose the stream, so it is flagged for update() to find.
+static void retire(State& s, Stream* stream)
+{
+    if (s.retired.try_push(stream)) return;
+
+    stream->orphaned.store(true, std::memory_order_release);
+    s.orphans.fetch_add(1, std::memory_order_release);
+}
+
+static void retire(Voice& v)
+{
+    if (v.stream) retire(*state, v.stream);
+    v = {};
+}
+
+static Voice* find_voice(VoiceId id)
+{
+    for (Voice& v : state->voices)
+        if (v.id == id) return &v;
+    return nullptr;
+}
+
+static Voice& claim_voice()
+{
+    for (Voice& v : state->voices)
+        if (v.id == 0) return v;
+
+    // Full: steal the oldest one-shot, or the oldest loop if everything loops
+    Voice* victim = &state->voices[0];
+    for (Voice& v : state->voices)
+    {
+        if (v.loop > victim->loop || (v.loop == victim->loop && v.started > victim->started)) continue;
+        victim = &v;
+    }
+
+    retire(*victim);
+    state->stolen.fetch_add(1, std::memory_order_relaxed);
+    return *victim;
+}
+
+static void apply(const Command& cmd)
+{
+    switch (cmd.type)
+    {
+    case CommandType::Play:
+    {
+        Voice& v = claim_voice();
+        v.id = cmd.voice;
+        v.sound = cmd.sound;
+        v.stream = cmd.stream;
+        v.volume = cmd.value;
+        v.pan = cmd.pan;
+        v.bus = cmd.bus;
+        v.loop = cmd.flag;
+        v.started = ++state->play_counter;
+        break;
+    }
+    case CommandType::Stop:
+        if (Voice* v = find_voice(cmd.voice)) retire(*v);
+        break;
+    case CommandType::StopAll:
+        for (Voice& v : state->voices)
+            if (v.id) retire(v);
+        break;
+    case CommandType::StopSound:
+        for (Voice& v : state->voices)
+            if (v.id && v.sound == cmd.sound) retire(v);
+        break;
+    case CommandType::Pause:
+        if (Voice* v = find_voice(cmd.voice)) v->paused = cmd.flag;
+        break;
+    case CommandType::Volume:
+        if (Voice* v = find_voice(cmd.voice)) v->volume = cmd.value;
+        break;
+    case CommandType::Pan:
+        if (Voice* v = find_voice(cmd.voice)) v->pan = cmd.pan;
+        break;
+    case CommandType::BusVolume:
+        state->bus_volume[std::size_t(cmd.bus)] = cmd.value;
+        break;
+    case CommandType::MasterVolume:
+        state->master_volume = cmd.value;
+        break;
+    }
+}
+
+// out += src * gain, interleaved stereo
+static void mix_stereo(float* out, const float* src, std::uint32_t frames, float left, float right)
+{
+    std::uint32_t i = 0;
+#ifdef KINE_AUDIO_SSE
+    const __m128 gain = _mm_setr_ps(left, right, left, right);
+    for (; i + 2 <= frames; i += 2)
+    {
+        __m128 acc = _mm_loadu_ps(out + i * 2);
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(src + i * 2), gain));
+        _mm_storeu_ps(out + i * 2, acc);
+    }
+#endif
+    for (; i < frames; ++i)
+    {
+        out[i * 2] += src[i * 2] * left;
+        out[i * 2 + 1] += src[i * 2 + 1] * right;
+    }
+}
+
+// Mix whatever the decode thread buffered; false once the stream ended and drained
+static bool mix_stream(Voice& v, float* out, std::uint32_t frames, float left, float right)
+{
+    StreamRing& ring = v.stream->ring;
+    const bool ended = v.stream->ended.load(std::memory_order_acquire);
+    const std::uint64_t read = ring.read.load(std::memory_order_relaxed);
+    const std::uint64_t available = ring.write.load(std::memory_order_acquire) - read;
+
+    const auto n = std::uint32_t(std::min<std::uint64_t>(frames, available));
+    if (n < frames && !ended) state->underruns.fetch_add(1, std::memory_order_relaxed);
+
+    // Up to two contiguous pieces around the wrap
+    const std::uint32_t offset = std::uint32_t(read & (ring.capacity - 1));
+    const std::uint32_t first = std::min(n, ring.capacity - offset);
+    mix_stereo(out, ring.samples.get() + offset * 2, first, left, right);
+    mix_stereo(out + first * 2, ring.samples.get(), n - first, left, right);
+
+    ring.read.store(read + n, std::memory_order_release);
+    return !(ended && n == available);
+}
+
+// False once the voice ran out
+static bool mix_voice(Voice& v, float* out, std::uint32_t frames)
+{
+    // Equal-power pan
+    const float gain = v.volume * state->bus_volume[std::size_t(v.bus)] * state->master_volume;
+    const float angle = (std::clamp(v.pan, -1.f, 1.f) + 1.f) * 0.785398163f;
+    const float left = gain * std::cos(angle);
+    const float right = gain * std::sin(angle);
+
+    if (v.stream) return mix_stream(v, out, frames, left, right);
+
+    while (frames > 0)
+    {
+        const auto n = std::uint32_t(std::min<std::uint64_t>(frames, v.sound->frames - v.cursor));
+        if (n > 0)
+        {
+            mix_stereo(out, v.sound->samples.data() + v.cursor * 2, n, left, right);
+            out += n * 2;
+            frames -= n;
+            v.cursor += n;
+            continue;
+        }
+
+        // Hit the end
+        if (!v.loop || v.cursor == 0) return false;
+        v.cursor = 0;
+    }
+    return true;
+}
+
+void mix(float* out, std::uint32_t frames)
+{
+    if (!state)
+    {
+        std::memset(out, 0, std::size_t(frames) * 2 * sizeof(float));
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    Command cmd;
+    std::uint64_t count = 0;
+    while (state->commands.try_pop(cmd))
+    {
+        apply(cmd);
+        ++count;
+    }
+    if (count) state->consumed.fetch_add(count, std::memory_order_release);
+
+    std::memset(out, 0, std::size_t(frames) * 2 * sizeof(float));
+
+    std::uint32_t playing = 0;
+    for (Voice& v : state->voices)
+    {
+        if (!v.id || v.paused)
+        {
+            playing += v.id != 0;
+            continue;
+        }
+
+        if (mix_voice(v, out, frames))
+            ++playing;
+        else
+            retire(v);
+    }
+
+    const auto ns = std::uint64_t(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+    state->callbacks.fetch_add(1, std::memory_order_relaxed);
+    state->frames.fetch_add(frames, std::memory_order_relaxed);
+    state->playing.store(playing, std::memory_order_relaxed);
+    state->mix_ns_last.store(ns, std::memory_order_relaxed);
+    if (ns > state->mix_ns_max.load(std::memory_order_relaxed)) state->mix_ns_max.store(ns, std::memory_order_relaxed);
+}
+
+static void data_callback(ma_device*, void* output, const void*, ma_uint32 frames)
+{
+    mix(static_cast<float*>(output), frames);
+}
+
+// --- Decode thread ---------------------------------------------------------
+
+// Decode until the ring is full or the stream ended
+static void fill(Stream* s)
+{
+    StreamRing& ring = s->ring;
+    bool rewound = false;
+
+    while (!s->ended.load(std::memory_order_relaxed))
+    {
+        const std::uint64_t write = ring.write.load(std::memory_order_relaxed);
+        const std::uint64_t space = ring.capacity - (write - ring.read.load(std::memory_order_acquire));
+        if (space < STREAM_CHUNK) return;
+
+        const std::uint32_t offset = std::uint32_t(write & (ring.capacity - 1));
+        const auto n = std::uint32_t(std::min<std::uint64_t>(space, ring.capacity - offset));
+
+        ma_uint64 read = 0;
+        ma_decoder_read_pcm_frames(&s->decoder, ring.samples.get() + offset * 2, n, &read);
+        if (read > 0)
+        {
+            ring.write.store(write + read, std::memory_order_release);
+            rewound = false;
+            continue;
+        }
+
+        // At the end: rewind once; a loop that yields nothing right after a rewind would spin forever
+        if (s->loop && !rewound && ma_decoder_seek_to_pcm_frame(&s->decoder, 0) == MA_SUCCESS)
+        {
+            rewound = true;
+            continue;
+        }
+        s->ended.store(true, std::memory_order_release);
+    }
+}
+
+static void decode_loop()
+{
+    std::unique_lock lock(state->streams_mutex);
+    while (!state->quit)
+    {
+        for (Stream* s : state->streams) fill(s);
+        state->streams_cv.wait_for(lock, DECODE_INTERVAL);
+    }
+}
+
+static void destroy_stream(Stream* s)
+{
+    if (s->decoder_ready) ma_decoder_uninit(&s->decoder);
+    pack::unmap_file(&s->file);
+    delete s;
+}
+
+// --- Game thread -----------------------------------------------------------
+
+static bool open_device(const ma_backend* backends, ma_uint32 backend_count)
+{
+    if (ma_context_init(backends, backend_count, nullptr, &state->context) != MA_SUCCESS) return false;
+
+    ma_device_config cfg = ma_device_config_init(ma_device_type_playback);
+    cfg.playback.format = ma_format_f32;
+    cfg.playback.channels = 2;
+    cfg.sampleRate = config.sample_rate;
+    cfg.periodSizeInFrames = config.period_frames;
+    cfg.performanceProfile = ma_performance_profile_low_latency;
+    cfg.dataCallback = data_callback;
+
+    if (ma_device_init(&state->context, &cfg, &state->device) != MA_SUCCESS)
+    {
+        ma_context_uninit(&state->context);
+        return false;
+    }
+
+    if (ma_device_start(&state->device) != MA_SUCCESS)
+    {
+        ma_device_uninit(&state->device);
+        ma_context_uninit(&state->context);
+        return false;
+    }
+
+    return true;
+}
+
+bool init()
+{
+    if (state) return state->initialized;
+
+    state = std::make_unique<State>();
+    state->bus_volume.fill(1.f);
+
+    if (config.backend != Backend::None)
+    {
+        const ma_backend null_backend = ma_backend_null;
+
+        if (config.backend == Backend::Default) state->has_device = open_device(nullptr, 0);
+
+        if (!state->has_device)
+        {
+            if (config.backend == Backend::Default) LOG_WARN("Audio: no playback device, using the null backend");
+            state->has_device = open_device(&null_backend, 1);
+        }
+
+        if (!state->has_device)
+        {
+            LOG_ERROR("Audio: failed to open a device");
+            return false;
+        }
+
+        LOG_INFO("Audio: {} Hz, {} frame periods on {}", state->device.sampleRate, config.period_frames,
+                 ma_get_backend_name(state->context.backend));
+    }
+
+    state->decode_thread = std::thread(decode_loop);
+    state->initialized = true;
+    return true;
+}
+
+void shutdown()
+{
+    if (!state) return;
+
+    if (state->has_device)
+    {
+        ma_device_uninit(&state->device);
+        ma_context_uninit(&state->context);
+    }
+
+    if (state->decode_thread.joinable())
+    {
+        {
+            std::lock_guard lock(state->streams_mutex);
+            state->quit = true;
+        }
+        state->streams_cv.notify_one();
+        state->decode_thread.join();
+    }
+
+    // The audio thread is gone, everything it held is ours now
+    for (Voice& v : state->voices) retire(v);
+
+    Command cmd;
+    while (state->commands.try_pop(cmd))
+        if (cmd.stream) retire(*state, cmd.stream);
+
+    state->unloads.clear();
+    update();
+
+    sounds.clear();
+    state.reset();
+}
+
+bool running() { return state && state->initialized; }
+
+void update()
+{
+    if (!state) return;
+
+    Stream* stream = nullptr;
+    while (state->retired.try_pop(stream))
+    {
+        {
+            std::lock_guard lock(state->streams_mutex);
+            std::erase(state->streams, stream);
+        }
+        destroy_stream(stream);
+    }
+
+    if (state->orphans.load(std::memory_order_acquire) > 0)
+    {
+        std::vector<Stream*> orphaned;
+        {
+            std::lock_guard lock(state->streams_mutex);
+            std::erase_if(state->streams,
+                          [&](Stream* s)
+                          {
+                              if (!s->orphaned.load(std::memory_order_acquire)) return false;
+                              orphaned.push_back(s);
+                              return true;
+                          });
+        }
+        state->orphans.fetch_sub(static_cast<std::uint32_t>(orphaned.size()), std::memory_order_relaxed);
+        for (Stream* s : orphaned) destroy_stream(s);
+    }
+
+    // A sound is freed once the audio thread consumed the StopSound that cut its voices
+    for (PendingUnload& u : state->unloads)
+    {
+        if (u.after) continue;
+
+        Command cmd;
+        cmd.type = CommandType::StopSound;
+        cmd.sound = u.sound;
+        if (submit(cmd)) u.after = state->submitted.load(std::memory_order_relaxed);
+    }
+
+    const std::uint64_t consumed = state->consumed.load(std::memory_order_acquire);
+    std::erase_if(state->unloads,
+                  [consumed](const PendingUnload& u)
+                  {
+                      if (!u.after || u.after > consumed) return false;
+                      sounds.erase(u.handle);
+                      return true;
+                  });
+}
+
+static ma_decoder_config decoder_config()
+{
+    return ma_decoder_config_init(ma_format_f32, 2, config.sample_rate);
+}
+
+SoundHandle load_sound(const std::string& name)
+{
+    if (SoundHandle existing = sounds.find(name))
+    {
+        sounds.acquire(existing);
+        return existing;
+    }
+
+    resource::AssetData data = resource::read_asset(name);
+
+    ma_decoder_config cfg = decoder_config();
+    ma_decoder decoder;
+    if (data.bytes.empty() || ma_decoder_init_memory(data.bytes.data(), data.bytes.size(), &cfg, &decoder) != MA_SUCCESS)
+    {
+        LOG_ERROR("Audio: cannot decode '{}'", name);
+        return {};
+    }
+
+    Sound sound;
+    ma_uint64 length = 0;
+    if (ma_decoder_get_length_in_pcm_frames(&decoder, &length) == MA_SUCCESS) sound.samples.reserve(length * 2);
+
+    // Length is only an estimate for some formats, so read until the decoder runs dry
+    std::array<float, STREAM_CHUNK * 2> chunk;
+    for (;;)
+    {
+        ma_uint64 read = 0;
+        ma_decoder_read_pcm_frames(&decoder, chunk.data(), STREAM_CHUNK, &read);
+        if (read == 0) break;
+        sound.samples.insert(sound.samples.end(), chunk.begin(), chunk.begin() + read * 2);
+    }
+    ma_decoder_uninit(&decoder);
+
+    sound.frames = sound.samples.size() / 2;
+    return sounds.insert(name, std::move(sound));
+}
+
+SoundHandle find_sound(const std::string& name) { return sounds.find(name); }
+
+void unload_sound(SoundHandle handle)
+{
+    const Sound* sound = sounds.get(handle);
+    if (!sound || sounds.release(handle) > 0) return;
+
+    if (!running())
+    {
+        sounds.erase(handle);
+        return;
+    }
+
+    // Dying until the StopSound is consumed: load_sound() no longer finds it and play() refuses it
+    sounds.forget(handle);
+    state->unloads.push_back({handle, sound});
+    update();
+}
+
+static VoiceId play_voice(const Sound* sound, Stream* stream, const PlayParams& params)
+{
+    Command cmd;
+    cmd.type = CommandType::Play;
+    cmd.voice = state->next_voice.fetch_add(1, std::memory_order_relaxed);
+    if (cmd.voice == 0) cmd.voice = state->next_voice.fetch_add(1, std::memory_order_relaxed);
+    cmd.sound = sound;
+    cmd.stream = stream;
+    cmd.value = params.volume;
+    cmd.pan = params.pan;
+    cmd.bus = params.bus;
+    cmd.flag = params.loop;
+
+    return submit(cmd) ? cmd.voice : 0;
+}
+
+VoiceId play(SoundHandle handle, const PlayParams& params)
+{
+    // No references left means an unload is pending, and a voice started now would outlive the samples
+    const Sound* sound = sounds.get(handle);
+    if (!sound || sounds.refs(handle) == 0 || !running()) return 0;
+
+    return play_voice(sound, nullptr, params);
+}
+
+VoiceId play_stream(const std::string& name, const PlayParams& params)
+{
+    if (!running()) return 0;
+
+    // Packed entries are views into the pack's mapping; loose files get mapped on their own
+    auto stream = std::make_unique<Stream>();
+    stream->bytes = resource::find_packed(name);
+    if (stream->bytes.empty() && pack::map_file(&stream->file, resource::get_path(name)))
+        stream->bytes = {stream->file.data, stream->file.size};
+
+    ma_decoder_config cfg = decoder_config();
+    stream->decoder_ready = !stream->bytes.empty() && ma_decoder_init_memory(stream->bytes.data(), stream->bytes.size(),
+                                                                             &cfg, &stream->decoder) == MA_SUCCESS;
+    if (!stream->decoder_ready)
+    {
+        LOG_ERROR("Audio: cannot stream '{}'", name);
+        destroy_stream(stream.release());
+        return 0;
+    }
+
+    stream->ring.capacity = std::bit_ceil(std::max(config.stream_buffer_frames, STREAM_CHUNK * 2));
+    stream->ring.samples = std::make_unique<float[]>(std::size_t(stream->ring.capacity) * 2);
+    stream->loop = params.loop;
+
+    // Prime the ring here so the first callback already has audio
+    fill(stream.get());
+
+    Stream* raw = stream.release();
+    VoiceId id = play_voice(nullptr, raw, params);
+    if (!id)
+    {
+        destroy_stream(raw);
+        return 0;
+    }
+
+    {
+        std::lock_guard lock(state->streams_mutex);
+        state->streams.push_back(raw);
+    }
+    state->streams_cv.notify_one();
+    return id;
+}
+
+static void voice_command(CommandType type, VoiceId voice, float value = 0.f, bool flag = false)
+{
+    if (!voice) return;
+
+    Command cmd;
+    cmd.type = type;
+    cmd.voice = voice;
+    cmd.value = value;
+    cmd.pan = value;
+    cmd.flag = flag;
+    submit(cmd);
+}
+
+void stop(VoiceId voice) { voice_command(CommandType::Stop, voice); }
+void pause(VoiceId voice, bool paused) { voice_command(CommandType::Pause, voice, 0.f, paused); }
+void set_volume(VoiceId voice, float volume) { voice_command(CommandType::Volume, voice, volume); }
+void set_pan(VoiceId voice, float pan) { voice_command(CommandType::Pan, voice, pan); }
+
+void stop_all()
+{
+    Command cmd;
+    cmd.type = CommandType::StopAll;
+    submit(cmd);
+}
+
+void set_bus_volume(Bus bus, float volume)
+{
+    Command cmd;
+    cmd.type = CommandType::BusVolume;
+    cmd.bus = bus;
+    cmd.value = volume;
+    submit(cmd);
+}
+
+void set_master_volume(float volume)
+{
+    Command cmd;
+    cmd.type = CommandType::MasterVolume;
+    cmd.value = volume;
+    submit(cmd);
+}
+
+Stats stats()
+{
+    Stats s;
+    if (!state) return s;
+
+    s.callbacks = state->callbacks.load(std::memory_order_relaxed);
+    s.frames = state->frames.load(std::memory_order_relaxed);
+    s.voices = state->playing.load(std::memory_order_relaxed);
+    s.mix_ns_last = state->mix_ns_last.load(std::memory_order_relaxed);
+    s.mix_ns_max = state->mix_ns_max.load(std::memory_order_relaxed);
+    s.stolen = state->stolen.load(std::memory_order_relaxed);
+    s.dropped = state->dropped.load(std::memory_order_relaxed);
+    s.underruns = state->underruns.load(std::memory_order_relaxed);
+
+    std::lock_guard lock(state->streams_mutex);
+    s.streams = std::uint32_t(state->streams.size());
+    for (const Stream* stream : state->streams) s.stream_bytes += std::size_t(stream->ring.capacity) * 2 * sizeof(float);
+    return s;
+}
+
+}  // namespace kine::audio
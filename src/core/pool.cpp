@@ -0,0 +1,116 @@
+#include "kine/core/pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <new>
+#include <utility>
+
+namespace kine
+{
+
+static constexpr std::align_val_t POOL_ALIGN{alignof(std::max_align_t)};
+
+BlockPool::BlockPool(std::size_t block_size, std::size_t blocks_per_chunk)
+    : size(std::max(block_size, sizeof(FreeBlock))), per_chunk(blocks_per_chunk)
+{
+}
+
+BlockPool::~BlockPool()
+{
+    for (std::byte* chunk : chunks) ::operator delete(chunk, POOL_ALIGN);
+}
+
+void* BlockPool::allocate()
+{
+    if (!free_list) add_chunk();
+
+    FreeBlock* block = free_list;
+    free_list = block->next;
+    ++live_blocks;
+    return block;
+}
+
+void BlockPool::deallocate(void* p)
+{
+    if (!p) return;
+
+    auto* block = static_cast<FreeBlock*>(p);
+    block->next = free_list;
+    free_list = block;
+    --live_blocks;
+}
+
+void BlockPool::add_chunk()
+{
+    auto* chunk = static_cast<std::byte*>(::operator new(size * per_chunk, POOL_ALIGN));
+    chunks.push_back(chunk);
+
+    // Thread the new blocks onto the free list, lowest address first
+    for (std::size_t i = per_chunk; i-- > 0;)
+    {
+        auto* block = reinterpret_cast<FreeBlock*>(chunk + i * size);
+        block->next = free_list;
+        free_list = block;
+    }
+}
+
+namespace flow_pool
+{
+    static constexpr std::size_t CLASS_COUNT = std::countr_zero(MAX_CLASS) - std::countr_zero(MIN_CLASS) + 1;
+
+    static std::size_t oversized_live = 0;
+
+    static std::array<BlockPool, CLASS_COUNT>& pools()
+    {
+        static std::array<BlockPool, CLASS_COUNT> instance = []<std::size_t... I>(std::index_sequence<I...>)
+        { return std::array<BlockPool, CLASS_COUNT>{BlockPool(MIN_CLASS << I)...}; }(std::make_index_sequence<CLASS_COUNT>{});
+        return instance;
+    }
+
+    static std::size_t class_index(std::size_t size)
+    {
+        if (size <= MIN_CLASS) return 0;
+        return std::bit_width(size - 1) - std::countr_zero(MIN_CLASS);
+    }
+
+    void* allocate(std::size_t size)
+    {
+        if (size > MAX_CLASS)
+        {
+            ++oversized_live;
+            return ::operator new(size, POOL_ALIGN);
+        }
+
+        return pools()[class_index(size)].allocate();
+    }
+
+    void deallocate(void* p, std::size_t size)
+    {
+        if (!p) return;
+
+        if (size > MAX_CLASS)
+        {
+            --oversized_live;
+            ::operator delete(p, POOL_ALIGN);
+            return;
+        }
+
+        pools()[class_index(size)].deallocate(p);
+    }
+
+    Stats stats()
+    {
+        Stats s{};
+        for (const BlockPool& pool : pools())
+        {
+            s.live += pool.live();
+            s.reserved += pool.reserved();
+            s.bytes += pool.reserved() * pool.block_size();
+        }
+        s.oversized = oversized_live;
+        return s;
+    }
+}  // namespace flow_pool
+
+}  // namespace kine
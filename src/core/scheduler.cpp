@@ -1,5 +1,9 @@
 #include "kine/core/scheduler.hpp"
 
+#include <cmath>
+
+#include "kine/core/time.hpp"
+
 namespace kine::scheduler
 {
 
@@ -92,15 +96,25 @@ void update(ECS& ecs, float dt, float alpha)
     for (auto& name : sorted) systems[name](ecs, dt, alpha);
 }
 
+void fixed_step(ECS& ecs, float fixed_dt, float alpha)
+{
+    if (dirty && !rebuild_order()) return;  // safe fail: skip update
+
+    for (auto& name : sorted) systems[name](ecs, fixed_dt, alpha);
+}
+
 void fixed_update(ECS& ecs, float& accumulator, float fixed_dt, float alpha)
 {
     if (dirty && !rebuild_order()) return;  // safe fail: skip update
 
-    while (accumulator >= fixed_dt)
+    for (int steps = 0; accumulator >= fixed_dt && steps < time::max_substeps; ++steps)
     {
         for (auto& name : sorted) systems[name](ecs, fixed_dt, alpha);
         accumulator -= fixed_dt;
     }
+
+    // Same as time::step(): at the substep cap the backlog is dropped, not carried into the next frame
+    if (accumulator >= fixed_dt) accumulator = std::fmod(accumulator, fixed_dt);
 }
 
 }  // namespace kine::scheduler
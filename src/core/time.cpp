@@ -1,6 +1,7 @@
 #include "kine/core/time.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include "GLFW/glfw3.h"
 
 namespace kine::time
@@ -9,13 +10,34 @@ namespace kine::time
 // TODO: Maybe turn this into inline void
 void begin_frame()
 {
-    float current_time = (float) glfwGetTime();
-    dt = current_time - last_frame_time;
-    last_frame_time = current_time;
+    const double clock = glfwGetTime();
+    begin_frame(clock, (float) clock - last_frame_time);
+}
+
+void begin_frame(double clock, float frame_dt)
+{
+    now = clock;
+    dt = frame_dt;
+    last_frame_time = (float) clock;
+
+    accumulator += std::min(dt, max_frame_dt);
+    substeps = 0;
+}
+
+bool step()
+{
+    if (accumulator >= fixed_dt && substeps < max_substeps)
+    {
+        accumulator -= fixed_dt;
+        ++substeps;
+        return true;
+    }
+
+    // Hit the substep cap: drop the backlog instead of carrying it forward
+    if (accumulator >= fixed_dt) accumulator = std::fmod(accumulator, fixed_dt);
 
-    accumulator += dt;
-    alpha = accumulator / fixed_dt;
-    alpha = std::clamp(alpha, 0.0f, 1.0f);
+    alpha = std::clamp(accumulator / fixed_dt, 0.0f, 1.0f);
+    return false;
 }
 
 }  // namespace kine::time
@@ -1,11 +1,59 @@
 #include "kine/flow/flow_object.hpp"
 
+#include <algorithm>
+#include <unordered_map>
+
+#include "kine/flow/flow_tree.hpp"
+
 namespace kine
 {
 
+struct GroupNameHash
+{
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+static std::unordered_map<std::string, GroupId, GroupNameHash, std::equal_to<>> group_ids;
+static std::vector<std::string> group_names;
+
+GroupId group_id(std::string_view name)
+{
+    auto it = group_ids.find(name);
+    if (it != group_ids.end()) return it->second;
+
+    GroupId id = static_cast<GroupId>(group_names.size());
+    group_names.emplace_back(name);
+    group_ids.emplace(group_names.back(), id);
+    return id;
+}
+
+GroupId find_group_id(std::string_view name)
+{
+    auto it = group_ids.find(name);
+    return it == group_ids.end() ? INVALID_GROUP : it->second;
+}
+
+const std::string& group_name(GroupId id)
+{
+    static const std::string unknown;
+    return id < group_names.size() ? group_names[id] : unknown;
+}
+
 FlowObject::~FlowObject()
 {
+    if (detached) return;  // on_detach, registries and entity already handled by FlowTree::flush
+
+    if (pending_attach && parent && parent->tree) parent->tree->forget(this);
+
     on_detach();
+    if (tree)
+    {
+        for (const GroupMembership& g : groups) tree->group_remove(this, g.id);
+        tree->type_remove(this);
+        tree->forget(this);
+    }
+
     if (entity) entity.destroy();
 }
 
@@ -18,9 +66,11 @@ void FlowObject::remove_child(FlowObject* child, bool free_memory)
     if (!free_memory)
     {
         (*it)->parent = nullptr;
+        it->release();
     }
 
     children.erase(it);
+    name_index_dirty = true;
 }
 
 void FlowObject::reparent(FlowObject* new_parent)
@@ -28,38 +78,123 @@ void FlowObject::reparent(FlowObject* new_parent)
     if (parent) parent->remove_child(this, false);
 
     new_parent->children.push_back(std::unique_ptr<FlowObject>(this));
+    new_parent->name_index_dirty = true;
     parent = new_parent;
 }
 
-FlowObject* FlowObject::find(const std::string& path)
+void FlowObject::rebuild_name_index()
 {
-    if (path.empty()) return nullptr;
+    name_index.clear();
+    name_index.reserve(children.size());
 
-    if (path == ".") return this;
-    if (path == "..") return parent;
+    for (std::uint32_t i = 0; i < children.size(); ++i)
+        name_index.try_emplace(std::hash<std::string_view>{}(children[i]->name), i);
 
-    size_t slash = path.find('/');
-    std::string part = path.substr(0, slash);
-    std::string rest = slash == std::string::npos ? "" : path.substr(slash + 1);
+    name_index_dirty = false;
+}
+
+FlowObject* FlowObject::find_child(std::string_view child_name)
+{
+    if (children.size() > NAME_INDEX_THRESHOLD)
+    {
+        if (name_index_dirty) rebuild_name_index();
+
+        auto it = name_index.find(std::hash<std::string_view>{}(child_name));
+        if (it != name_index.end() && it->second < children.size() && children[it->second]->name == child_name)
+            return children[it->second].get();
+    }
 
     for (auto& c : children)
     {
-        if (c->name == part) return rest.empty() ? c.get() : c->find(rest);
+        if (c->name != child_name) continue;
+
+        // Found by scan: a child was renamed or the index is stale
+        if (children.size() > NAME_INDEX_THRESHOLD) name_index_dirty = true;
+        return c.get();
+    }
+
+    return nullptr;
+}
+
+FlowObject* FlowObject::find(std::string_view path)
+{
+    if (path.empty()) return nullptr;
+
+    FlowObject* node = this;
+    while (node)
+    {
+        const size_t slash = path.find('/');
+        const std::string_view part = path.substr(0, slash);
+
+        if (part == "..")
+            node = node->parent;
+        else if (!part.empty() && part != ".")
+            node = node->find_child(part);
+
+        if (slash == std::string_view::npos) return node;
+        path.remove_prefix(slash + 1);
+        if (path.empty()) return node;
     }
 
     return nullptr;
 }
 
-FlowObject* FlowObject::find_or_null(const std::string& path)
+FlowObject* FlowObject::find_or_null(std::string_view path)
 {
     FlowObject* node = find(path);
     return node ? node : nullptr;
 }
 
-void FlowObject::add_to_group(const std::string& group) { groups.insert(group); }
-void FlowObject::remove_from_group(const std::string& group) { groups.erase(group); }
-bool FlowObject::is_in_group(const std::string& group) const { return groups.count(group); }
+void FlowObject::add_to_group(std::string_view group) { add_to_group(group_id(group)); }
 
-void FlowObject::queue_free() { queued_for_deletion = true; }
+void FlowObject::add_to_group(GroupId group)
+{
+    if (group == INVALID_GROUP || is_in_group(group)) return;
+
+    groups.push_back({group});
+    if (tree) tree->group_add(this, group);
+}
+
+void FlowObject::remove_from_group(std::string_view group) { remove_from_group(find_group_id(group)); }
+
+void FlowObject::remove_from_group(GroupId group)
+{
+    auto it = std::find_if(groups.begin(), groups.end(), [&](const GroupMembership& g) { return g.id == group; });
+    if (it == groups.end()) return;
+
+    if (tree) tree->group_remove(this, group);
+    groups.erase(it);
+}
+
+bool FlowObject::is_in_group(std::string_view group) const { return is_in_group(find_group_id(group)); }
+
+bool FlowObject::is_in_group(GroupId group) const
+{
+    return std::any_of(groups.begin(), groups.end(), [&](const GroupMembership& g) { return g.id == group; });
+}
+
+void FlowObject::queue_reparent(FlowObject* new_parent)
+{
+    if (!new_parent || new_parent == parent) return;
+
+    if (tree)
+        tree->pending_reparents.emplace_back(this, new_parent);
+    else
+        reparent(new_parent);
+}
+
+void FlowObject::queue_free()
+{
+    if (queued_for_deletion) return;
+
+    queued_for_deletion = true;
+    if (tree) tree->pending_free.push_back(this);
+}
+
+void FlowObject::queue_attach(FlowObject* child)
+{
+    child->pending_attach = true;
+    tree->pending_attach.push_back(child);
+}
 
 }  // namespace kine
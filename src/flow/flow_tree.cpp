@@ -1,4 +1,7 @@
 #include "kine/flow/flow_tree.hpp"
+
+#include <algorithm>
+
 #include "kine/flow/flow_object.hpp"
 
 namespace kine
@@ -7,8 +10,7 @@ namespace kine
 void FlowTree::finalize()
 {
     if (!root || ready) return;
-    attach_recursive(root.get());
-    init_recursive(root.get());
+    attach_subtrees({root.get()});
 
     ready = true;
 }
@@ -25,55 +27,243 @@ void FlowTree::fixed_update(float fixed_dt)
     fixed_update_recursive(root.get(), fixed_dt);
 }
 
-void FlowTree::attach_recursive(FlowObject* obj)
+// Callbacks may add children or queue nodes for deletion, so iterate by
+// index and skip nodes that are not (or no longer) live.
+void FlowTree::update_recursive(FlowObject* obj, float dt)
 {
-    obj->entity = ecs.create();
-    obj->on_attach();
+    if (!obj->enabled || obj->pending_attach || obj->queued_for_deletion) return;
+    if (!obj->pause_mode) obj->update(dt);
+    for (size_t i = 0; i < obj->children.size(); ++i) update_recursive(obj->children[i].get(), dt);
+}
 
-    for (auto& c : obj->children) attach_recursive(c.get());
+void FlowTree::fixed_update_recursive(FlowObject* obj, float dt)
+{
+    if (!obj->enabled || obj->pending_attach || obj->queued_for_deletion) return;
+    if (!obj->pause_mode) obj->fixed_update(dt);
+    for (size_t i = 0; i < obj->children.size(); ++i) fixed_update_recursive(obj->children[i].get(), dt);
 }
 
-void FlowTree::init_recursive(FlowObject* obj)
+// Skips nodes already in the tree, which a reparent can put under a pending parent, and claims the rest so a
+// pending root reparented under another pending root is only collected once
+static void collect_preorder(FlowTree* tree, FlowObject* obj, std::vector<FlowObject*>& out)
 {
-    obj->init();
-    for (auto& c : obj->children) init_recursive(c.get());
+    if (obj->tree == tree) return;
+    obj->tree = tree;
+
+    out.push_back(obj);
+    for (auto& c : obj->children) collect_preorder(tree, c.get(), out);
 }
 
-void FlowTree::update_recursive(FlowObject* obj, float dt)
+static bool has_queued_ancestor(const FlowObject* obj)
 {
-    if (!obj->enabled) return;
-    if (!obj->pause_mode) obj->update(dt);
-    for (auto& c : obj->children) update_recursive(c.get(), dt);
+    for (const FlowObject* p = obj->parent; p; p = p->parent)
+        if (p->queued_for_deletion) return true;
+    return false;
 }
 
-void FlowTree::fixed_update_recursive(FlowObject* obj, float dt)
+void FlowTree::flush()
 {
-    if (!obj->enabled) return;
-    if (!obj->pause_mode) obj->fixed_update(dt);
-    for (auto& c : obj->children) fixed_update_recursive(c.get(), dt);
+    if (!ready || !has_pending()) return;
+
+    // Take the queues so callbacks run below can queue work for the next flush
+    auto reparents = std::exchange(pending_reparents, {});
+    auto attach = std::exchange(pending_attach, {});
+    auto frees = std::exchange(pending_free, {});
+    auto commands = std::exchange(pending_commands, {});
+
+    for (auto& [obj, new_parent] : reparents) obj->reparent(new_parent);
+
+    // Subtrees that are going away anyway are freed without being attached
+    std::erase_if(attach,
+                  [&](FlowObject* obj)
+                  {
+                      if (obj->queued_for_deletion) frees.push_back(obj);
+                      return obj->queued_for_deletion || has_queued_ancestor(obj);
+                  });
+    if (!attach.empty()) attach_subtrees(attach);
+
+    // attach_subtrees() re-queues nodes that were marked before attaching
+    frees.insert(frees.end(), pending_free.begin(), pending_free.end());
+    pending_free.clear();
+    if (!frees.empty()) free_subtrees(frees);
+
+    for (auto& command : commands) command(ecs);
 }
 
-void FlowTree::remove_queued_objs()
+void FlowTree::attach_subtrees(const std::vector<FlowObject*>& roots)
 {
-    std::function<void(FlowObject*, FlowObject*)> recurse = [&](FlowObject*, FlowObject* node)
+    scratch_nodes.clear();
+    for (FlowObject* obj : roots)
+    {
+        obj->pending_attach = false;
+        collect_preorder(this, obj, scratch_nodes);
+    }
+
+    scratch_entities.resize(scratch_nodes.size());
+    ecs.create(scratch_entities.begin(), scratch_entities.end());
+
+    // Copy: on_attach()/init() may add children, which re-enters the queues
+    const std::vector<FlowObject*> nodes = scratch_nodes;
+
+    for (size_t i = 0; i < nodes.size(); ++i)
     {
-        if (!node) return;
+        FlowObject* obj = nodes[i];
+        obj->tree = this;
+        obj->entity = Entity{&ecs, scratch_entities[i]};
+
+        for (const GroupMembership& g : obj->groups) group_add(obj, g.id);
+        type_add(obj);
+
+        if (obj->queued_for_deletion) pending_free.push_back(obj);
+    }
+
+    for (FlowObject* obj : nodes) obj->on_attach();
+    for (FlowObject* obj : nodes) obj->init();
+}
+
+void FlowTree::free_subtrees(const std::vector<FlowObject*>& queued)
+{
+    std::vector<FlowObject*> roots;
+    roots.reserve(queued.size());
+    for (FlowObject* obj : queued)
+        if (!has_queued_ancestor(obj)) roots.push_back(obj);
+
+    scratch_entities.clear();
+    for (FlowObject* obj : roots) detach_recursive(obj);
 
-        auto it = node->children.begin();
-        while (it != node->children.end())
+    if (!scratch_entities.empty()) ecs.destroy(scratch_entities.begin(), scratch_entities.end());
+
+    scratch_parents.clear();
+    for (FlowObject* obj : roots)
+    {
+        if (obj == root.get())
         {
-            FlowObject* child = it->get();
-            if (child->queued_for_deletion)
-            {
-                it = node->children.erase(it);
-                continue;
-            }
-            recurse(node, child);
-            ++it;
+            root.reset();
+            ready = false;
+            return;
         }
-    };
 
-    recurse(nullptr, root.get());
+        FlowObject* parent = obj->parent;
+        if (parent && std::find(scratch_parents.begin(), scratch_parents.end(), parent) == scratch_parents.end())
+            scratch_parents.push_back(parent);
+    }
+
+    // One compaction per parent keeps sibling (and therefore update) order
+    for (FlowObject* parent : scratch_parents)
+    {
+        auto& children = parent->children;
+        children.erase(std::remove_if(children.begin(), children.end(),
+                                      [](const std::unique_ptr<FlowObject>& c) { return c->queued_for_deletion; }),
+                       children.end());
+        parent->name_index_dirty = true;
+    }
+}
+
+void FlowTree::detach_recursive(FlowObject* obj)
+{
+    obj->on_detach();
+
+    for (const GroupMembership& g : obj->groups) group_remove(obj, g.id);
+    type_remove(obj);
+
+    if (obj->entity) scratch_entities.push_back(obj->entity.raw());
+    obj->entity = Entity{};
+    obj->tree = nullptr;
+    obj->detached = true;
+
+    for (auto& c : obj->children) detach_recursive(c.get());
+}
+
+// A node destroyed outside flush() must not stay in the queues
+void FlowTree::forget(FlowObject* obj)
+{
+    if (!has_pending()) return;
+
+    std::erase(pending_free, obj);
+    std::erase(pending_attach, obj);
+    std::erase_if(pending_reparents, [&](const auto& r) { return r.first == obj || r.second == obj; });
+}
+
+const std::vector<FlowObject*>& FlowTree::get_group(std::string_view group) const
+{
+    return get_group(find_group_id(group));
+}
+
+const std::vector<FlowObject*>& FlowTree::get_group(GroupId group) const
+{
+    static const std::vector<FlowObject*> empty;
+    return group < group_members.size() ? group_members[group] : empty;
+}
+
+static GroupMembership* membership(FlowObject* obj, GroupId group)
+{
+    for (GroupMembership& g : obj->groups)
+        if (g.id == group) return &g;
+    return nullptr;
+}
+
+void FlowTree::group_add(FlowObject* obj, GroupId group)
+{
+    GroupMembership* m = membership(obj, group);
+    if (!m) return;
+
+    if (group >= group_members.size()) group_members.resize(group + 1);
+
+    auto& members = group_members[group];
+    m->slot = static_cast<uint32_t>(members.size());
+    members.push_back(obj);
 }
 
+void FlowTree::group_remove(FlowObject* obj, GroupId group)
+{
+    GroupMembership* m = membership(obj, group);
+    if (!m || group >= group_members.size()) return;
+
+    auto& members = group_members[group];
+    if (m->slot >= members.size() || members[m->slot] != obj) return;
+
+    // Swap-remove, then patch the moved member's slot
+    FlowObject* last = members.back();
+    members[m->slot] = last;
+    if (GroupMembership* moved = membership(last, group)) moved->slot = m->slot;
+    members.pop_back();
+
+    m->slot = UINT32_MAX;
+}
+
+void FlowTree::type_add(FlowObject* obj)
+{
+    if (obj->type_bucket != UINT32_MAX) return;
+
+    const std::type_index type(typeid(*obj));
+    auto [it, inserted] = type_lookup.try_emplace(type, static_cast<uint32_t>(types.size()));
+    if (inserted) types.push_back(TypeBucket{type, {}});
+
+    auto& members = types[it->second].members;
+    obj->type_bucket = it->second;
+    obj->type_slot = static_cast<uint32_t>(members.size());
+    members.push_back(obj);
+}
+
+void FlowTree::type_remove(FlowObject* obj)
+{
+    if (obj->type_bucket >= types.size()) return;
+
+    auto& members = types[obj->type_bucket].members;
+    if (obj->type_slot < members.size() && members[obj->type_slot] == obj)
+    {
+        FlowObject* last = members.back();
+        members[obj->type_slot] = last;
+        last->type_slot = obj->type_slot;
+        members.pop_back();
+    }
+
+    obj->type_bucket = UINT32_MAX;
+    obj->type_slot = UINT32_MAX;
+}
+
+const std::vector<TypeBucket>& type_buckets(const FlowTree* tree) { return tree->types; }
+
+const FlowObject* tree_root(const FlowTree* tree) { return tree->root.get(); }
+
 }  // namespace kine
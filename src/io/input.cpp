@@ -1,20 +1,25 @@
 #include "kine/io/input.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 #include "GLFW/glfw3.h"
+#include "kine/log.hpp"
 
 namespace kine::input
 {
 
 #define GET_INPUT                                                     \
     Input* i = static_cast<Input*>(glfwGetWindowUserPointer(window)); \
-    if (!i) return;
+    if (!i || !i->live) return;
 
 static void key_callback(GLFWwindow* window, int key, int, int action, int)
 {
     GET_INPUT;
     if (key < 0 || key >= MAX_KEYS) return;
 
-    if (action == GLFW_PRESS || action == GLFW_REPEAT)
+    // Repeats carry no transition
+    if (action == GLFW_PRESS)
         input::set_key_state(i, key, true);
     else if (action == GLFW_RELEASE)
         input::set_key_state(i, key, false);
@@ -44,16 +49,174 @@ static void scroll_callback(GLFWwindow* window, double xOffset, double yOffset)
 }
 #undef GET_INPUT
 
+// Cap on events waiting for a fixed step, in case nothing ever steps
+static constexpr std::size_t MAX_PENDING = 4 * INPUT_QUEUE_CAPACITY;
+
+template <std::size_t N>
+static void set_button(ButtonState<N>& s, int code, bool down, double time)
+{
+    if (code < 0 || code >= int(N)) return;
+
+    if (down && !s.down[code])
+    {
+        if (s.presses[code] < UINT8_MAX) ++s.presses[code];
+        s.press_time[code] = time;
+    }
+    else if (!down && s.down[code])
+    {
+        if (s.releases[code] < UINT8_MAX) ++s.releases[code];
+    }
+    s.down[code] = down;
+}
+
+template <std::size_t N>
+static void clear_transitions(ButtonState<N>& s)
+{
+    s.presses.fill(0);
+    s.releases.fill(0);
+}
+
+// Start a new frame or step window on s
+static void begin_window(InputState& s)
+{
+    clear_transitions(s.keys);
+    clear_transitions(s.mouse);
+    clear_transitions(s.pad);
+    s.prev_mouse_position = s.mouse_position;
+    s.mouse_scroll = {0.0f, 0.0f};
+}
+
+static void apply(InputState& s, const InputEvent& e)
+{
+    switch (e.type)
+    {
+    case InputEventType::Key:
+        set_button(s.keys, e.code, e.down, e.time);
+        break;
+    case InputEventType::MouseButton:
+        set_button(s.mouse, e.code, e.down, e.time);
+        break;
+    case InputEventType::MouseMove:
+        s.mouse_position = e.value;
+        break;
+    case InputEventType::Scroll:
+        s.mouse_scroll += e.value;
+        break;
+    case InputEventType::GamepadButton:
+        set_button(s.pad, e.code, e.down, e.time);
+        break;
+    case InputEventType::GamepadAxis:
+        if (e.code >= 0 && e.code < MAX_GAMEPAD_AXES) s.axes[e.code] = e.value.x;
+        break;
+    }
+}
+
+static InputState& active(Input* i) { return i->in_step ? i->step : i->frame; }
+static ActionState& active_actions(Input* i) { return i->in_step ? i->step_actions : i->frame_actions; }
+
+static int find_gamepad(const Input* i)
+{
+    if (i->gamepad >= 0) return glfwJoystickIsGamepad(i->gamepad) ? i->gamepad : -1;
+
+    for (int jid = GLFW_JOYSTICK_1; jid <= GLFW_JOYSTICK_LAST; ++jid)
+        if (glfwJoystickIsGamepad(jid)) return jid;
+    return -1;
+}
+
+// Gamepads have no callbacks; poll and turn changes into events so steps see them like keys
+static void poll_gamepad(Input* i)
+{
+    if (!window::get() || !i->live) return;
+
+    GLFWgamepadstate pad{};
+    const int jid = find_gamepad(i);
+    if (jid >= 0 && !glfwGetGamepadState(jid, &pad)) pad = {};
+
+    const double time = now();
+    const InputState& s = i->frame;
+
+    for (int b = 0; b < MAX_GAMEPAD_BUTTONS; ++b)
+    {
+        const bool down = pad.buttons[b] == GLFW_PRESS;
+        if (down != s.pad.down[b]) push_event(i, {time, InputEventType::GamepadButton, down, int16_t(b), {}});
+    }
+    for (int a = 0; a < MAX_GAMEPAD_AXES; ++a)
+    {
+        if (pad.axes[a] != s.axes[a])
+            push_event(i, {time, InputEventType::GamepadAxis, false, int16_t(a), {pad.axes[a], 0.f}});
+    }
+}
+
+/**
+ * @brief Fold every binding into the action bitsets for one frame or step.
+ *
+ * An action is pressed if it went down since the last evaluation or one of
+ * its buttons was tapped within the window, and released symmetrically.
+ */
+static void evaluate(const Input* i, const InputState& s, ActionState& a)
+{
+    const std::bitset<MAX_ACTIONS> was_down = a.down;
+    std::bitset<MAX_ACTIONS> taps, lifts;
+
+    a.down.reset();
+    std::fill_n(a.values.begin(), i->action_names.size(), 0.f);
+
+    for (const Binding& b : i->bindings)
+    {
+        bool held = false;
+        float value = 0.f;
+
+        switch (b.source)
+        {
+        case BindingSource::Key:
+        case BindingSource::MouseButton:
+        case BindingSource::GamepadButton:
+        {
+            auto transitions = [&](const auto& buttons)
+            {
+                held = buttons.down[b.code];
+                if (buttons.presses[b.code]) taps.set(b.action);
+                if (buttons.releases[b.code]) lifts.set(b.action);
+            };
+            if (b.source == BindingSource::Key)
+                transitions(s.keys);
+            else if (b.source == BindingSource::MouseButton)
+                transitions(s.mouse);
+            else
+                transitions(s.pad);
+
+            value = held ? b.scale : 0.f;
+            break;
+        }
+        case BindingSource::GamepadAxis:
+        {
+            const float raw = s.axes[b.code];
+            value = std::abs(raw) > i->deadzone ? raw * b.scale : 0.f;
+            held = raw * b.scale > 0.5f;
+            break;
+        }
+        }
+
+        if (held) a.down.set(b.action);
+        a.values[b.action] += value;
+    }
+
+    for (std::size_t id = 0; id < i->action_names.size(); ++id) a.values[id] = std::clamp(a.values[id], -1.f, 1.f);
+
+    a.pressed = (a.down | taps) & ~was_down;
+    a.released = (was_down | lifts) & ~a.down;
+}
+
 void create(Input* i)
 {
-    i->current_keys.fill(false);
-    i->prev_keys.fill(false);
-    i->current_mouse.fill(false);
-    i->prev_mouse.fill(false);
+    i->frame = {};
+    i->step = {};
+    i->frame_actions = {};
+    i->step_actions = {};
+    i->in_step = false;
 
-    i->mouse_position = {0.0f, 0.0f};
-    i->prev_mouse_position = i->mouse_position;
-    i->mouse_scroll = {0.0f, 0.0f};
+    i->events.reserve(INPUT_QUEUE_CAPACITY);
+    i->pending.reserve(INPUT_QUEUE_CAPACITY);
 }
 
 void init(Input* i)
@@ -67,99 +230,261 @@ void init(Input* i)
 
 void begin_frame(Input* i)
 {
-    i->prev_keys = i->current_keys;
-    i->prev_mouse = i->current_mouse;
-    i->prev_mouse_position = i->mouse_position;
+    begin_window(i->frame);
+
+    // Whatever the last step consumed is done with
+    i->pending.erase(i->pending.begin(), i->pending.begin() + std::ptrdiff_t(i->step_count));
+    i->step_count = 0;
+
+    poll_gamepad(i);
+
+    i->events.clear();
+    InputEvent e;
+    while (i->queue.try_pop(e)) i->events.push_back(e);
+
+    // Producers on other threads can interleave; keep the stream in time order
+    auto by_time = [](const InputEvent& a, const InputEvent& b) { return a.time < b.time; };
+    if (!std::is_sorted(i->events.begin(), i->events.end(), by_time))
+        std::stable_sort(i->events.begin(), i->events.end(), by_time);
 
-    i->mouse_scroll = {0.0f, 0.0f};  // reset every frame
+    for (const InputEvent& ev : i->events) apply(i->frame, ev);
+    evaluate(i, i->frame, i->frame_actions);
+
+    i->pending.insert(i->pending.end(), i->events.begin(), i->events.end());
+    if (i->pending.size() > MAX_PENDING)
+        i->pending.erase(i->pending.begin(), i->pending.end() - std::ptrdiff_t(MAX_PENDING));
 }
 
 void shutdown(Input* i)
 {
-    i->current_keys = {};
-    i->prev_keys = {};
-    i->current_mouse = {};
-    i->prev_mouse = {};
+    i->frame = {};
+    i->step = {};
+    i->frame_actions = {};
+    i->step_actions = {};
+    i->in_step = false;
+
+    i->events.clear();
+    i->pending.clear();
+    i->step_count = 0;
 
-    i->mouse_position = {};
-    i->prev_mouse_position = {};
-    i->mouse_scroll = {};
+    InputEvent e;
+    while (i->queue.try_pop(e)) {}
 
     glfwSetWindowUserPointer(window::get(), NULL);
 }
 
-void set_key_state(Input* i, int key, bool down) { i->current_keys[key] = down; }
-void set_mouse_button_state(Input* i, int button, bool down) { i->current_mouse[button] = down; }
-void set_mouse_position(Input* i, float x, float y) { i->mouse_position = {x, y}; }
-void set_mouse_scroll(Input* i, float x, float y) { i->mouse_scroll = {x, y}; }
+double now() { return glfwGetTime(); }
+
+void push_event(Input* i, const InputEvent& event)
+{
+    if (!i->queue.try_push(event)) i->dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void set_key_state(Input* i, int key, bool down)
+{
+    push_event(i, {now(), InputEventType::Key, down, int16_t(key), {}});
+}
+
+void set_mouse_button_state(Input* i, int button, bool down)
+{
+    push_event(i, {now(), InputEventType::MouseButton, down, int16_t(button), {}});
+}
+
+void set_mouse_position(Input* i, float x, float y)
+{
+    push_event(i, {now(), InputEventType::MouseMove, false, 0, {x, y}});
+}
+
+void set_mouse_scroll(Input* i, float x, float y) { push_event(i, {now(), InputEventType::Scroll, false, 0, {x, y}}); }
+
+void begin_step(Input* i, double until)
+{
+    i->pending.erase(i->pending.begin(), i->pending.begin() + std::ptrdiff_t(i->step_count));
+
+    begin_window(i->step);
+
+    std::size_t n = 0;
+    while (n < i->pending.size() && i->pending[n].time <= until) apply(i->step, i->pending[n++]);
+    evaluate(i, i->step, i->step_actions);
+
+    i->step_count = n;
+    i->in_step = true;
+}
+
+void end_step(Input* i) { i->in_step = false; }
+
+std::span<const InputEvent> frame_events(const Input* i) { return i->events; }
+std::span<const InputEvent> step_events(const Input* i) { return {i->pending.data(), i->step_count}; }
 
 #define VALID key < 0 || key >= MAX_KEYS
 bool key_down(Input* i, int key)
 {
     if (VALID) return false;
-    return i->current_keys[key];
+    return active(i).keys.down[key];
 }
 bool key_pressed(Input* i, int key)
 {
     if (VALID) return false;
-    return i->current_keys[key] && !i->prev_keys[key];
+    return active(i).keys.presses[key] > 0;
 }
 bool key_released(Input* i, int key)
 {
     if (VALID) return false;
-    return !i->current_keys[key] && i->prev_keys[key];
+    return active(i).keys.releases[key] > 0;
+}
+double key_pressed_time(Input* i, int key)
+{
+    if (VALID) return -1.0;
+    const ButtonState<MAX_KEYS>& keys = active(i).keys;
+    return keys.presses[key] > 0 ? keys.press_time[key] : -1.0;
 }
 #undef VALID
 #define VALID button < 0 || button >= MAX_MOUSE_BUTTONS
 bool mouse_down(Input* i, int button)
 {
     if (VALID) return false;
-    return i->current_mouse[button];
+    return active(i).mouse.down[button];
 }
 bool mouse_pressed(Input* i, int button)
 {
     if (VALID) return false;
-    return i->current_mouse[button] && !i->prev_mouse[button];
+    return active(i).mouse.presses[button] > 0;
 }
 bool mouse_released(Input* i, int button)
 {
     if (VALID) return false;
-    return !i->current_mouse[button] && i->prev_mouse[button];
+    return active(i).mouse.releases[button] > 0;
 }
 #undef VALID
 
-void bind_key(Input* i, const std::string& action, int key) { i->bindings[action].keys.push_back(key); }
-void bind_mouse_button(Input* i, const std::string& action, int button)
+vec2 mouse_position(Input* i) { return active(i).mouse_position; }
+vec2 mouse_delta(Input* i) { return active(i).mouse_position - active(i).prev_mouse_position; }
+vec2 mouse_scroll(Input* i) { return active(i).mouse_scroll; }
+
+#define VALID button < 0 || button >= MAX_GAMEPAD_BUTTONS
+bool gamepad_down(Input* i, int button)
 {
-    i->bindings[action].mouse_buttons.push_back(button);
+    if (VALID) return false;
+    return active(i).pad.down[button];
+}
+bool gamepad_pressed(Input* i, int button)
+{
+    if (VALID) return false;
+    return active(i).pad.presses[button] > 0;
+}
+bool gamepad_released(Input* i, int button)
+{
+    if (VALID) return false;
+    return active(i).pad.releases[button] > 0;
+}
+#undef VALID
+float gamepad_axis(Input* i, int axis)
+{
+    if (axis < 0 || axis >= MAX_GAMEPAD_AXES) return 0.f;
+    return active(i).axes[axis];
 }
 
-bool is_action_down(Input* i, const std::string& action)
+ActionId action(Input* i, const std::string& name)
 {
-    auto it = i->bindings.find(action);
-    if (it == i->bindings.end()) return false;
+    auto it = i->action_ids.find(name);
+    if (it != i->action_ids.end()) return it->second;
+
+    if (i->action_names.size() >= MAX_ACTIONS) LOG_THROW("Input: more than {} actions registered", MAX_ACTIONS);
 
-    for (int key : it->second.keys)
-        if (key_down(i, key)) return true;
+    const ActionId id = static_cast<ActionId>(i->action_names.size());
+    i->action_names.push_back(name);
+    i->action_ids.emplace(name, id);
+    return id;
+}
+
+void bind(Input* i, const Binding& binding)
+{
+    int limit = 0;
+    switch (binding.source)
+    {
+    case BindingSource::Key:
+        limit = MAX_KEYS;
+        break;
+    case BindingSource::MouseButton:
+        limit = MAX_MOUSE_BUTTONS;
+        break;
+    case BindingSource::GamepadButton:
+        limit = MAX_GAMEPAD_BUTTONS;
+        break;
+    case BindingSource::GamepadAxis:
+        limit = MAX_GAMEPAD_AXES;
+        break;
+    }
 
-    for (int button : it->second.mouse_buttons)
-        if (mouse_down(i, button)) return true;
+    if (binding.action >= i->action_names.size() || binding.code < 0 || binding.code >= limit)
+    {
+        LOG_WARN("Input: ignoring binding of code {} to unknown action {}", binding.code, binding.action);
+        return;
+    }
 
-    return false;
+    // Keep each action's bindings adjacent so evaluation walks the table in order
+    auto by_action = [](const Binding& a, const Binding& b) { return a.action < b.action; };
+    i->bindings.insert(std::upper_bound(i->bindings.begin(), i->bindings.end(), binding, by_action), binding);
 }
 
-bool is_action_pressed(Input* i, const std::string& action)
+void bind_key(Input* i, ActionId action, int key, float scale)
 {
-    auto it = i->bindings.find(action);
-    if (it == i->bindings.end()) return false;
+    bind(i, {action, BindingSource::Key, int16_t(key), scale});
+}
+void bind_mouse_button(Input* i, ActionId action, int button, float scale)
+{
+    bind(i, {action, BindingSource::MouseButton, int16_t(button), scale});
+}
+void bind_gamepad_button(Input* i, ActionId action, int button, float scale)
+{
+    bind(i, {action, BindingSource::GamepadButton, int16_t(button), scale});
+}
+void bind_gamepad_axis(Input* i, ActionId action, int axis, float scale)
+{
+    bind(i, {action, BindingSource::GamepadAxis, int16_t(axis), scale});
+}
+
+void clear_bindings(Input* i, ActionId action)
+{
+    std::erase_if(i->bindings, [action](const Binding& b) { return b.action == action; });
+}
+
+#define VALID action >= MAX_ACTIONS
+bool action_down(Input* i, ActionId action)
+{
+    if (VALID) return false;
+    return active_actions(i).down.test(action);
+}
+bool action_pressed(Input* i, ActionId action)
+{
+    if (VALID) return false;
+    return active_actions(i).pressed.test(action);
+}
+bool action_released(Input* i, ActionId action)
+{
+    if (VALID) return false;
+    return active_actions(i).released.test(action);
+}
+float action_value(Input* i, ActionId action)
+{
+    if (VALID) return 0.f;
+    return active_actions(i).values[action];
+}
+#undef VALID
 
-    for (int key : it->second.keys)
-        if (key_pressed(i, key)) return true;
+void bind_key(Input* i, const std::string& name, int key) { bind_key(i, action(i, name), key); }
+void bind_mouse_button(Input* i, const std::string& name, int button) { bind_mouse_button(i, action(i, name), button); }
 
-    for (int button : it->second.mouse_buttons)
-        if (mouse_pressed(i, button)) return true;
+bool is_action_down(Input* i, const std::string& name)
+{
+    auto it = i->action_ids.find(name);
+    return it != i->action_ids.end() && action_down(i, it->second);
+}
 
-    return false;
+bool is_action_pressed(Input* i, const std::string& name)
+{
+    auto it = i->action_ids.find(name);
+    return it != i->action_ids.end() && action_pressed(i, it->second);
 }
 
 }  // namespace kine::input
@@ -0,0 +1,211 @@
+#include "kine/io/replay.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "kine/core/time.hpp"
+#include "kine/log.hpp"
+
+namespace kine::replay
+{
+
+template <typename T>
+static void put(std::vector<std::byte>& out, const T& v)
+{
+    const std::size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &v, sizeof(T));
+}
+
+template <typename T>
+static bool get(Replay* r, T& v)
+{
+    if (r->data.size() - r->cursor < sizeof(T)) return false;
+    std::memcpy(&v, r->data.data() + r->cursor, sizeof(T));
+    r->cursor += sizeof(T);
+    return true;
+}
+
+static bool has_value(InputEventType type)
+{
+    return type == InputEventType::MouseMove || type == InputEventType::Scroll || type == InputEventType::GamepadAxis;
+}
+
+void start_recording(Replay* r, const std::string& path, std::uint64_t seed)
+{
+    *r = {};
+    r->mode = Mode::Record;
+    r->path = path;
+    r->seed = seed;
+
+    r->header.max_substeps = time::max_substeps;
+    r->header.fixed_dt = time::fixed_dt;
+    r->header.max_frame_dt = time::max_frame_dt;
+    r->header.accumulator = time::accumulator;
+    r->header.last_frame_time = time::last_frame_time;
+    r->header.seed = seed;
+
+    LOG_INFO("Replay: recording to {}", path);
+}
+
+bool start_replay(Replay* r, const std::string& path)
+{
+    *r = {};
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        LOG_ERROR("Replay: cannot open {}", path);
+        return false;
+    }
+
+    r->data.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(r->data.data()), static_cast<std::streamsize>(r->data.size()));
+
+    if (!file || !get(r, r->header) || r->header.magic != MAGIC || r->header.version != VERSION)
+    {
+        LOG_ERROR("Replay: {} is not a version {} recording", path, VERSION);
+        *r = {};
+        return false;
+    }
+
+    r->mode = Mode::Replay;
+    r->path = path;
+    r->seed = r->header.seed;
+    r->frame_ms.reserve(r->header.frame_count);
+
+    time::max_substeps = r->header.max_substeps;
+    time::fixed_dt = r->header.fixed_dt;
+    time::max_frame_dt = r->header.max_frame_dt;
+    time::accumulator = r->header.accumulator;
+    time::last_frame_time = r->header.last_frame_time;
+
+    LOG_INFO("Replay: playing {} ({} frames)", path, r->header.frame_count);
+    return true;
+}
+
+void stop(Replay* r)
+{
+    if (r->mode == Mode::Record)
+    {
+        std::vector<std::byte> out;
+        out.reserve(sizeof(Header) + r->data.size());
+        put(out, r->header);
+        out.insert(out.end(), r->data.begin(), r->data.end());
+
+        std::ofstream file(r->path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+        if (file)
+            LOG_INFO("Replay: wrote {} frames ({} bytes) to {}", r->header.frame_count, out.size(), r->path);
+        else
+            LOG_ERROR("Replay: failed to write {}", r->path);
+    }
+    else if (r->mode == Mode::Replay)
+    {
+        const Timings t = timings(r);
+        LOG_INFO("Replay: {} frames, mean {} ms, p50 {} ms, p90 {} ms, p99 {} ms, max {} ms", t.frames, t.mean_ms,
+                 t.p50_ms, t.p90_ms, t.p99_ms, t.max_ms);
+    }
+
+    *r = {};
+}
+
+bool play_frame(Replay* r, Input* i)
+{
+    const auto clock_now = std::chrono::steady_clock::now();
+    if (r->frame > 0)
+        r->frame_ms.push_back(std::chrono::duration<float, std::milli>(clock_now - r->frame_start).count());
+    r->frame_start = clock_now;
+
+    double clock = 0.0;
+    float dt = 0.f;
+    std::uint32_t count = 0;
+    if (r->frame >= r->header.frame_count || !get(r, clock) || !get(r, dt) || !get(r, count))
+    {
+        time::begin_frame(time::now, 0.f);
+        return false;
+    }
+
+    time::begin_frame(clock, dt);
+
+    for (std::uint32_t n = 0; n < count; ++n)
+    {
+        InputEvent e;
+        std::uint8_t type = 0, down = 0;
+        if (!get(r, e.time) || !get(r, type) || !get(r, down) || !get(r, e.code))
+        {
+            LOG_ERROR("Replay: {} is truncated at frame {}", r->path, r->frame);
+            r->header.frame_count = r->frame;
+            return false;
+        }
+
+        e.type = static_cast<InputEventType>(type);
+        e.down = down != 0;
+        if (has_value(e.type) && (!get(r, e.value.x) || !get(r, e.value.y)))
+        {
+            LOG_ERROR("Replay: {} is truncated at frame {}", r->path, r->frame);
+            r->header.frame_count = r->frame;
+            return false;
+        }
+
+        input::push_event(i, e);
+    }
+
+    ++r->frame;
+    return true;
+}
+
+void record_frame(Replay* r, const Input* i)
+{
+    const std::span<const InputEvent> events = input::frame_events(i);
+
+    put(r->data, time::now);
+    put(r->data, time::dt);
+    put(r->data, static_cast<std::uint32_t>(events.size()));
+
+    for (const InputEvent& e : events)
+    {
+        put(r->data, e.time);
+        put(r->data, static_cast<std::uint8_t>(e.type));
+        put(r->data, static_cast<std::uint8_t>(e.down));
+        put(r->data, e.code);
+        if (has_value(e.type))
+        {
+            put(r->data, e.value.x);
+            put(r->data, e.value.y);
+        }
+    }
+
+    ++r->header.frame_count;
+}
+
+Timings timings(const Replay* r)
+{
+    Timings t;
+    t.frames = r->frame_ms.size();
+    if (t.frames == 0) return t;
+
+    std::vector<float> sorted = r->frame_ms;
+    std::sort(sorted.begin(), sorted.end());
+
+    // Nearest rank
+    auto percentile = [&sorted](double p)
+    {
+        const std::size_t rank = static_cast<std::size_t>(p * double(sorted.size() - 1) + 0.5);
+        return double(sorted[rank]);
+    };
+
+    double sum = 0.0;
+    for (float ms : sorted) sum += double(ms);
+
+    t.mean_ms = sum / double(t.frames);
+    t.p50_ms = percentile(0.50);
+    t.p90_ms = percentile(0.90);
+    t.p99_ms = percentile(0.99);
+    t.max_ms = double(sorted.back());
+    return t;
+}
+
+}  // namespace kine::replay
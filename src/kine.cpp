@@ -1,16 +1,40 @@
 #include "kine/kine.hpp"
 
+#include <cstdlib>
+
 namespace kine
 {
 
+// KINE_RECORD=<file> records this session, KINE_REPLAY=<file> plays one back,
+// KINE_HEADLESS=1 hides the window and drops vsync
+static void read_environment()
+{
+    const char* headless = std::getenv("KINE_HEADLESS");
+    window::headless = headless && *headless && *headless != '0';
+
+    if (const char* path = std::getenv("KINE_REPLAY"))
+    {
+        replay::start_replay(&replay_session, path);
+    }
+    else if (const char* record = std::getenv("KINE_RECORD"))
+    {
+        const auto seed = std::chrono::steady_clock::now().time_since_epoch().count();
+        replay::start_recording(&replay_session, record, static_cast<std::uint64_t>(seed));
+    }
+}
+
 void create(int width, int height, const char* title)
 {
+    read_environment();
+
     scheduler::init();
     render::init();
     window::create(width, height, title);
     resource::create();
 
     input::create(&global_input);
+    // A replay stands in for the clock and the devices from the first poll on, so no live event gets mixed in
+    global_input.live = replay_session.mode != replay::Mode::Replay;
     renderer2d::create(&renderer);
 
     flow_tree = new FlowTree();
@@ -19,6 +43,7 @@ void create(int width, int height, const char* title)
 void init()
 {
     resource::init();
+    audio::init();
     renderer2d::init(&renderer);
     input::init(&global_input);
 
@@ -27,32 +52,72 @@ void init()
 
 void begin_frame()
 {
-    time::begin_frame();
+    // Poll first so every event of this frame is stamped before time::now
+    glfwPollEvents();
+
+    if (!global_input.live)
+    {
+        if (!replay::play_frame(&replay_session, &global_input)) running = false;
+    }
+    else
+    {
+        time::begin_frame();
+    }
+
     input::begin_frame(&global_input);
+    if (replay_session.mode == replay::Mode::Record) replay::record_frame(&replay_session, &global_input);
     if (window::should_close()) running = false;
 
-    glfwPollEvents();
+    // Finish a slice of background texture loads while the context is current
+    resource::async::pump();
+    resource::hot_reload::poll();
+    audio::update();
 }
 
 void update()
 {
     float dt = delta_time();
+    ECS& ecs = flow_tree->ecs;
+
+    // FlowObjects, scheduler systems and physics step together, at the fixed rate. Each step
+    // sees the input events that fell in its slice of time, not the whole frame's.
+    double step_end = time::now - double(time::accumulator);
+    while (time::step())
+    {
+        step_end += double(time::fixed_dt);
+        input::begin_step(&global_input, step_end);
+
+        interpolation::snapshot(ecs);
+        flow_tree->fixed_update(time::fixed_dt);
+        scheduler::fixed_step(ecs, time::fixed_dt, time::alpha);
+        physics::step(ecs, time::fixed_dt);
+
+        input::end_step(&global_input);
+    }
 
     flow_tree->update(dt);
-    flow_tree->fixed_update(time::fixed_dt);
+    scheduler::update(ecs, dt, time::alpha);
+    particles::update(&renderer.particles, dt);
 
-    scheduler::update(flow_tree->ecs, dt, time::alpha);
-    scheduler::fixed_update(flow_tree->ecs, time::accumulator, time::fixed_dt, time::alpha);
+    // Sync point for spawns, frees, reparents and deferred ECS changes
+    flow_tree->flush();
 }
 
-void render_frame() { renderer2d::render(&renderer); }
+void render_frame()
+{
+    renderer2d::render(&renderer);
+    resource::residency::update();
+}
 
 void shutdown()
 {
+    replay::stop(&replay_session);
     input::shutdown(&global_input);
+    audio::shutdown();
     resource::shutdown();
     renderer2d::shutdown(&renderer);
     scheduler::shutdown();
+    interpolation::reset();
 
 #define RESET(x) \
     delete x;    \
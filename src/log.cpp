@@ -0,0 +1,339 @@
+#include "kine/log.hpp"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "kine/core/mpsc_queue.hpp"
+
+namespace kine::log
+{
+
+static constexpr std::size_t BATCH = 64;
+
+struct Backend
+{
+    MpscQueue<Record, RING_CAPACITY> ring;
+
+    std::thread writer;
+    std::thread::id writer_id;
+    std::once_flag started;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> async{true};
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+
+    std::atomic<std::uint64_t> submitted{0};
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::uint64_t dropped_reported = 0;
+
+    // Sites that have had repeats, for the writer to report
+    std::atomic<Site*> repeating{nullptr};
+
+    std::FILE* file = nullptr;  // Guarded by log_mutex
+    std::string console_batch;
+    std::string file_batch;
+};
+
+// Never destroyed, so messages logged during static destruction still have somewhere to go
+static Backend& backend()
+{
+    static Backend* b = new Backend();
+    return *b;
+}
+
+static void append_line(std::string& out, const Record& r, bool color)
+{
+    out += '[';
+    out += time_string(r.time);
+    out += "] ";
+    if (color) out += level_color(r.level);
+    out += level_name(r.level);
+    out += ' ';
+    out.append(r.text, r.length);
+    if (color && use_color) out += "\033[0m";
+    if (r.length == 0 || r.text[r.length - 1] != '\n') out += '\n';
+}
+
+// Caller holds log_mutex
+static void emit(Backend& b, const Record* records, std::size_t count)
+{
+    const Handler h = handler;
+    b.console_batch.clear();
+    b.file_batch.clear();
+
+    for (std::size_t n = 0; n < count; ++n)
+    {
+        const Record& r = records[n];
+        if (h == default_handler)
+            append_line(b.console_batch, r, true);
+        else if (h)
+            h(r.level, std::string_view(r.text, r.length));
+
+        if (b.file) append_line(b.file_batch, r, false);
+    }
+
+    if (!b.console_batch.empty())
+    {
+        std::fwrite(b.console_batch.data(), 1, b.console_batch.size(), stdout);
+        std::fflush(stdout);
+    }
+    if (!b.file_batch.empty()) std::fwrite(b.file_batch.data(), 1, b.file_batch.size(), b.file);
+}
+
+static void report_drops(Backend& b, Record* batch, std::size_t& count)
+{
+    const std::uint64_t dropped_now = b.dropped.load(std::memory_order_relaxed);
+    if (dropped_now == b.dropped_reported) return;
+
+    Record& r = batch[count++];
+    r.level = Level::Warn;
+    r.time = std::chrono::system_clock::now();
+    auto result = std::format_to_n(r.text, MESSAGE_CAPACITY, "Log: {} messages dropped, ring full",
+                                   dropped_now - b.dropped_reported);
+    r.length = static_cast<std::uint32_t>(result.out - r.text);
+    b.dropped_reported = dropped_now;
+}
+
+// FNV-1a
+static std::uint64_t hash(const char* text, std::size_t length)
+{
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::size_t n = 0; n < length; ++n)
+    {
+        h ^= static_cast<unsigned char>(text[n]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static std::int64_t now_ms()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// The format string stands in for the repeated message, whose text is gone by now
+static void submit_repeats(Site* site, std::uint32_t repeats)
+{
+    Record note;
+    note.level = site->level.load(std::memory_order_relaxed);
+    note.time = std::chrono::system_clock::now();
+
+    const std::string_view format(site->format.load(std::memory_order_relaxed),
+                                  site->format_size.load(std::memory_order_relaxed));
+    auto result = std::format_to_n(note.text, MESSAGE_CAPACITY, "\"{}\" repeated {} times", format, repeats);
+    note.length = static_cast<std::uint32_t>(std::min<std::ptrdiff_t>(result.size, MESSAGE_CAPACITY));
+    submit(note);
+}
+
+// Report sites that have been repeating but went quiet; all of them when stopping
+static void sweep_repeats(Backend& b, bool all)
+{
+    const std::int64_t now = now_ms();
+    for (Site* site = b.repeating.load(std::memory_order_acquire); site;
+         site = site->next.load(std::memory_order_relaxed))
+    {
+        if (site->repeats.load(std::memory_order_relaxed) == 0) continue;
+        if (!all && now - site->last_emit.load(std::memory_order_relaxed) < 1000) continue;
+
+        // Let the next identical message print again
+        site->last_hash.store(0, std::memory_order_relaxed);
+        if (const std::uint32_t repeats = site->repeats.exchange(0, std::memory_order_relaxed))
+            submit_repeats(site, repeats);
+    }
+}
+
+static void writer_loop(Backend& b)
+{
+    static Record batch[BATCH + 1];
+
+    for (;;)
+    {
+        std::size_t count = 0;
+        while (count < BATCH && b.ring.try_pop(batch[count])) ++count;
+        const std::size_t popped = count;
+        report_drops(b, batch, count);
+
+        if (count > 0)
+        {
+            {
+                std::scoped_lock lock(log_mutex);
+                emit(b, batch, count);
+                if (b.file && popped < BATCH) std::fflush(b.file);
+            }
+            b.written.fetch_add(popped, std::memory_order_release);
+            continue;
+        }
+
+        if (b.stopping.load(std::memory_order_acquire)) break;
+
+        sweep_repeats(b, false);
+        std::unique_lock lock(b.wake_mutex);
+        b.wake.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+static void write_now(const Record& record)
+{
+    std::scoped_lock lock(log_mutex);
+    emit(backend(), &record, 1);
+}
+
+void submit(const Record& record)
+{
+    Backend& b = backend();
+    if (!b.async.load(std::memory_order_relaxed) || b.stopping.load(std::memory_order_acquire))
+    {
+        write_now(record);
+        return;
+    }
+
+    std::call_once(b.started,
+                   [&b]
+                   {
+                       b.writer = std::thread(writer_loop, std::ref(b));
+                       b.writer_id = b.writer.get_id();
+                       std::atexit(shutdown);
+                   });
+
+    if (!b.ring.try_push(record))
+    {
+        b.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    b.submitted.fetch_add(1, std::memory_order_release);
+    b.wake.notify_one();
+}
+
+void submit(Site* site, std::string_view format, const Record& record, std::uint32_t suppressed)
+{
+    const std::uint64_t h = hash(record.text, record.length);
+    const std::int64_t now = now_ms();
+
+    if (site->last_hash.load(std::memory_order_relaxed) == h &&
+        now - site->last_emit.load(std::memory_order_relaxed) < 1000)
+    {
+        if (site->repeats.fetch_add(1, std::memory_order_relaxed) == 0 &&
+            !site->listed.exchange(true, std::memory_order_relaxed))
+        {
+            site->format.store(format.data(), std::memory_order_relaxed);
+            site->format_size.store(format.size(), std::memory_order_relaxed);
+            site->level.store(record.level, std::memory_order_relaxed);
+
+            Backend& b = backend();
+            Site* head = b.repeating.load(std::memory_order_relaxed);
+            do
+                site->next.store(head, std::memory_order_relaxed);
+            while (!b.repeating.compare_exchange_weak(head, site, std::memory_order_release));
+        }
+        return;
+    }
+
+    const std::uint32_t repeats = site->repeats.exchange(0, std::memory_order_relaxed);
+    if (repeats > 0) submit_repeats(site, repeats);
+
+    site->last_hash.store(h, std::memory_order_relaxed);
+    site->last_emit.store(now, std::memory_order_relaxed);
+
+    if (suppressed > 0)
+    {
+        Record note;
+        note.level = record.level;
+        note.time = record.time;
+        auto result = std::format_to_n(note.text, MESSAGE_CAPACITY, "Rate limit dropped {} messages from \"{}\"",
+                                       suppressed, format);
+        note.length = static_cast<std::uint32_t>(std::min<std::ptrdiff_t>(result.size, MESSAGE_CAPACITY));
+        submit(note);
+    }
+
+    submit(record);
+}
+
+void flush()
+{
+    Backend& b = backend();
+    if (!b.writer.joinable() || std::this_thread::get_id() == b.writer_id) return;
+
+    const std::uint64_t target = b.submitted.load(std::memory_order_acquire);
+    while (b.written.load(std::memory_order_acquire) < target && !b.stopping.load(std::memory_order_acquire))
+    {
+        b.wake.notify_one();
+        std::this_thread::yield();
+    }
+
+    std::scoped_lock lock(log_mutex);
+    if (b.file) std::fflush(b.file);
+}
+
+void shutdown()
+{
+    Backend& b = backend();
+    if (b.stopping.load(std::memory_order_acquire)) return;
+
+    sweep_repeats(b, true);
+    if (b.stopping.exchange(true, std::memory_order_acq_rel)) return;
+
+    if (b.writer.joinable())
+    {
+        b.wake.notify_one();
+        b.writer.join();
+    }
+
+    std::scoped_lock lock(log_mutex);
+    if (b.file) std::fflush(b.file);
+}
+
+void set_async(bool async)
+{
+    Backend& b = backend();
+    if (!async) flush();
+    b.async.store(async, std::memory_order_relaxed);
+}
+
+bool open_file(const std::string& path)
+{
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    close_file();
+    std::scoped_lock lock(log_mutex);
+    backend().file = f;
+    return true;
+}
+
+void close_file()
+{
+    flush();
+
+    std::scoped_lock lock(log_mutex);
+    Backend& b = backend();
+    if (b.file) std::fclose(b.file);
+    b.file = nullptr;
+}
+
+std::uint64_t dropped() { return backend().dropped.load(std::memory_order_relaxed); }
+
+bool admit(Site* site, Level lvl, std::uint32_t& suppressed)
+{
+    if (site_rate_limit == 0 || lvl >= Level::Critical) return true;
+
+    const std::int64_t now = now_ms();
+    std::int64_t window = site->window.load(std::memory_order_relaxed);
+    if (now - window >= 1000 && site->window.compare_exchange_strong(window, now, std::memory_order_relaxed))
+    {
+        site->count.store(0, std::memory_order_relaxed);
+        suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    if (site->count.fetch_add(1, std::memory_order_relaxed) < site_rate_limit) return true;
+
+    site->suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+}  // namespace kine::log
@@ -0,0 +1,1343 @@
+#include "kine/physics/physics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "kine/log.hpp"
+
+namespace kine::physics
+{
+
+// Bodies spanning more grid cells than this are tested against everything instead
+static constexpr std::int32_t MAX_CELLS = 16;
+static constexpr std::uint32_t NARROWPHASE_CHUNK = 64;
+// Radians a body may turn in one step
+static constexpr float MAX_ROTATION = 0.25f * 3.1415927f;
+static constexpr std::uint32_t NONE = ~0u;
+
+// / WORKERS // /
+
+// One pool for all worlds. Items are claimed from an atomic counter, so a big island
+// keeps one thread busy while the others drain the small ones.
+struct Workers
+{
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    std::function<void(std::uint32_t)> job;
+    std::atomic<std::uint32_t> next{0};
+    std::uint32_t count = 0;
+    std::uint64_t generation = 0;
+    std::size_t finished = 0;
+    bool quit = false;
+
+    ~Workers()
+    {
+        {
+            std::scoped_lock lock(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : threads) t.join();
+    }
+};
+
+static Workers workers;
+
+static void run_items()
+{
+    for (;;)
+    {
+        const std::uint32_t i = workers.next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= workers.count) return;
+        workers.job(i);
+    }
+}
+
+static void worker_loop()
+{
+    std::uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock lock(workers.mutex);
+            workers.wake.wait(lock, [&] { return workers.quit || workers.generation != seen; });
+            if (workers.quit) return;
+            seen = workers.generation;
+        }
+
+        run_items();
+
+        std::scoped_lock lock(workers.mutex);
+        if (++workers.finished == workers.threads.size()) workers.done.notify_one();
+    }
+}
+
+// Runs fn(0) .. fn(count - 1) across the caller and up to extra worker threads
+static void parallel_for(unsigned extra, std::uint32_t count, std::function<void(std::uint32_t)> fn)
+{
+    if (extra == 0 || count < 2)
+    {
+        for (std::uint32_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    {
+        std::scoped_lock lock(workers.mutex);
+        while (workers.threads.size() < extra) workers.threads.emplace_back(worker_loop);
+
+        workers.job = std::move(fn);
+        workers.count = count;
+        workers.next.store(0, std::memory_order_relaxed);
+        workers.finished = 0;
+        ++workers.generation;
+    }
+    workers.wake.notify_all();
+
+    run_items();
+
+    // Every worker checks in, so none is still reading job when the next call replaces it
+    std::unique_lock lock(workers.mutex);
+    workers.done.wait(lock, [] { return workers.finished == workers.threads.size(); });
+}
+
+// / END WORKERS / //
+
+static std::uint64_t pair_key(std::uint32_t a, std::uint32_t b) { return std::uint64_t(a) << 32 | b; }
+
+static std::uint64_t elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+static bool slot(const World* w, BodyId id, std::uint32_t& i)
+{
+    if (!w || id.index >= w->capacity) return false;
+
+    i = id.index;
+    return w->bodies.live[i] && w->bodies.generation[i] == id.generation;
+}
+
+static void grow(Bodies& b, std::uint32_t n)
+{
+    auto resize = [n](auto&... arrays) { (arrays.resize(n), ...); };
+    resize(b.position, b.angle, b.rot, b.velocity, b.angular_velocity, b.force, b.torque, b.inv_mass, b.inv_inertia,
+           b.friction, b.restitution, b.linear_damping, b.angular_damping, b.gravity_scale, b.category, b.mask,
+           b.shape, b.aabb, b.min_extent, b.max_extent, b.type, b.awake, b.sleep_time, b.sleep_island, b.owner, b.live);
+    b.generation.resize(n, 1);
+}
+
+World& create_world(ECS& ecs, const Config& config)
+{
+    World w;
+    w.config = config;
+    ecs.remove_context<World>();
+    return ecs.set_context<World>(std::move(w));
+}
+
+World* get_world(ECS& ecs) { return ecs.has_context<World>() ? &ecs.get_context<World>() : nullptr; }
+
+bool valid(const World* w, BodyId id)
+{
+    std::uint32_t i;
+    return slot(w, id, i);
+}
+
+static void wake_island(World* w, std::uint32_t island)
+{
+    Bodies& b = w->bodies;
+    for (std::uint32_t i : w->sleeping[island])
+    {
+        b.awake[i] = 1;
+        b.sleep_time[i] = 0.f;
+        b.sleep_island[i] = NO_ISLAND;
+    }
+    w->sleeping[island].clear();
+    w->free_islands.push_back(island);
+}
+
+static void wake_body(World* w, std::uint32_t i)
+{
+    Bodies& b = w->bodies;
+    if (b.type[i] != BodyType::Dynamic) return;
+
+    if (b.sleep_island[i] != NO_ISLAND) wake_island(w, b.sleep_island[i]);
+    b.awake[i] = 1;
+    b.sleep_time[i] = 0.f;
+}
+
+// Wake everything touching i, for when i moves or disappears under them
+static void wake_touching(World* w, std::uint32_t i)
+{
+    for (const Contact& c : w->contacts)
+    {
+        if (c.a == i) wake_body(w, c.b);
+        if (c.b == i) wake_body(w, c.a);
+    }
+}
+
+BodyId create_body(World* w, const BodyDef& def, entt::entity owner)
+{
+    std::uint32_t i;
+    if (!w->free_slots.empty())
+    {
+        i = w->free_slots.back();
+        w->free_slots.pop_back();
+    }
+    else
+    {
+        i = w->capacity++;
+        grow(w->bodies, w->capacity);
+    }
+
+    Bodies& b = w->bodies;
+    const bool dynamic = def.type == BodyType::Dynamic;
+    const MassData mass = compute_mass(def.shape, def.density);
+
+    b.position[i] = def.position;
+    b.angle[i] = def.angle;
+    b.rot[i] = rotation(def.angle);
+    b.velocity[i] = def.type == BodyType::Static ? vec2(0.f) : def.velocity;
+    b.angular_velocity[i] = def.type == BodyType::Static ? 0.f : def.angular_velocity;
+    b.force[i] = vec2(0.f);
+    b.torque[i] = 0.f;
+
+    b.inv_mass[i] = dynamic ? 1.f / std::max(mass.mass, 1e-6f) : 0.f;
+    b.inv_inertia[i] = dynamic && !def.fixed_rotation && mass.inertia > 0.f ? 1.f / mass.inertia : 0.f;
+    b.friction[i] = def.friction;
+    b.restitution[i] = def.restitution;
+    b.linear_damping[i] = def.linear_damping;
+    b.angular_damping[i] = def.angular_damping;
+    b.gravity_scale[i] = def.gravity_scale;
+    b.category[i] = def.category;
+    b.mask[i] = def.mask;
+
+    b.shape[i] = def.shape;
+    b.aabb[i] = compute_aabb(def.shape, def.position, b.rot[i]);
+    b.min_extent[i] = min_extent(def.shape);
+    b.max_extent[i] = max_extent(def.shape);
+    b.type[i] = def.type;
+
+    const bool moving = def.velocity != vec2(0.f) || def.angular_velocity != 0.f;
+    b.awake[i] = dynamic || (def.type == BodyType::Kinematic && moving);
+    b.sleep_time[i] = 0.f;
+    b.sleep_island[i] = NO_ISLAND;
+    b.owner[i] = owner;
+    b.live[i] = 1;
+    w->grid_dirty = true;
+
+    return {i, b.generation[i]};
+}
+
+void destroy_body(World* w, BodyId id)
+{
+    std::uint32_t i;
+    if (!slot(w, id, i)) return;
+
+    Bodies& b = w->bodies;
+    wake_body(w, i);
+    wake_touching(w, i);
+    std::erase_if(w->contacts, [i](const Contact& c) { return c.a == i || c.b == i; });
+
+    b.live[i] = 0;
+    b.awake[i] = 0;
+    b.owner[i] = entt::null;
+    if (++b.generation[i] == 0) b.generation[i] = 1;
+    w->grid_dirty = true;
+    w->free_slots.push_back(i);
+}
+
+BodyId add_body(Entity e, const BodyDef& def)
+{
+    World* w = get_world(*e.get_ecs());
+    if (!w) LOG_THROW("physics::add_body: the ECS has no physics world, call physics::create_world() first");
+
+    remove_body(e);
+    const BodyId id = create_body(w, def, e.raw());
+    e.add<Body>(id);
+    e.add_or_get<Pose>() = {def.position, def.angle};
+    return id;
+}
+
+void remove_body(Entity e)
+{
+    if (!e.has<Body>()) return;
+
+    destroy_body(get_world(*e.get_ecs()), e.get<Body>().id);
+    e.remove<Body>();
+}
+
+vec2 position(const World* w, BodyId id)
+{
+    std::uint32_t i;
+    return slot(w, id, i) ? w->bodies.position[i] : vec2(0.f);
+}
+
+float angle(const World* w, BodyId id)
+{
+    std::uint32_t i;
+    return slot(w, id, i) ? w->bodies.angle[i] : 0.f;
+}
+
+vec2 velocity(const World* w, BodyId id)
+{
+    std::uint32_t i;
+    return slot(w, id, i) ? w->bodies.velocity[i] : vec2(0.f);
+}
+
+float angular_velocity(const World* w, BodyId id)
+{
+    std::uint32_t i;
+    return slot(w, id, i) ? w->bodies.angular_velocity[i] : 0.f;
+}
+
+bool is_awake(const World* w, BodyId id)
+{
+    std::uint32_t i;
+    return slot(w, id, i) && w->bodies.awake[i];
+}
+
+void set_transform(World* w, BodyId id, vec2 position, float angle)
+{
+    std::uint32_t i;
+    if (!slot(w, id, i)) return;
+
+    Bodies& b = w->bodies;
+    b.position[i] = position;
+    b.angle[i] = angle;
+    b.rot[i] = rotation(angle);
+    b.aabb[i] = compute_aabb(b.shape[i], position, b.rot[i]);
+    w->grid_dirty = true;
+
+    wake_body(w, i);
+    // Contacts of a body that was not awake are kept as they were, so refresh its neighbours too
+    wake_touching(w, i);
+}
+
+void set_velocity(World* w, BodyId id, vec2 velocity, float angular_velocity)
+{
+    std::uint32_t i;
+    if (!slot(w, id, i) || w->bodies.type[i] == BodyType::Static) return;
+
+    Bodies& b = w->bodies;
+    b.velocity[i] = velocity;
+    b.angular_velocity[i] = angular_velocity;
+    if (b.type[i] == BodyType::Kinematic) b.awake[i] = velocity != vec2(0.f) || angular_velocity != 0.f;
+    wake_body(w, i);
+}
+
+void apply_force(World* w, BodyId id, vec2 force)
+{
+    std::uint32_t i;
+    if (!slot(w, id, i) || w->bodies.type[i] != BodyType::Dynamic) return;
+
+    w->bodies.force[i] += force;
+    wake_body(w, i);
+}
+
+void apply_torque(World* w, BodyId id, float torque)
+{
+    std::uint32_t i;
+    if (!slot(w, id, i) || w->bodies.type[i] != BodyType::Dynamic) return;
+
+    w->bodies.torque[i] += torque;
+    wake_body(w, i);
+}
+
+void apply_impulse(World* w, BodyId id, vec2 impulse, vec2 point)
+{
+    std::uint32_t i;
+    if (!slot(w, id, i) || w->bodies.type[i] != BodyType::Dynamic) return;
+
+    Bodies& b = w->bodies;
+    b.velocity[i] += b.inv_mass[i] * impulse;
+    b.angular_velocity[i] += b.inv_inertia[i] * cross(point - b.position[i], impulse);
+    wake_body(w, i);
+}
+
+void wake(World* w, BodyId id)
+{
+    std::uint32_t i;
+    if (slot(w, id, i)) wake_body(w, i);
+}
+
+// / BROADPHASE // /
+
+static std::uint32_t cell_hash(std::int32_t x, std::int32_t y)
+{
+    return std::uint32_t(x) * 73856093u ^ std::uint32_t(y) * 19349663u;
+}
+
+static AABB fattened(const Bodies& b, std::uint32_t i, float margin)
+{
+    return {b.aabb[i].min - margin, b.aabb[i].max + margin};
+}
+
+static void consider(World* w, std::uint32_t i, std::uint32_t j, float margin)
+{
+    const Bodies& b = w->bodies;
+    if (b.type[i] != BodyType::Dynamic && b.type[j] != BodyType::Dynamic) return;
+    if (!b.awake[i] && !b.awake[j]) return;
+    if (!(b.category[i] & b.mask[j]) || !(b.category[j] & b.mask[i])) return;
+    if (!overlaps(fattened(b, i, margin), fattened(b, j, margin))) return;
+
+    w->pairs.push_back(i < j ? pair_key(i, j) : pair_key(j, i));
+}
+
+// LSD radix sort over the bits the slot indices in a key can use; far cheaper than std::sort at this size
+static void sort_pairs(World* w)
+{
+    constexpr int DIGIT = 11;
+    constexpr std::uint32_t MASK = (1u << DIGIT) - 1;
+
+    int bits = 1;
+    while (bits < 32 && (std::uint64_t(1) << bits) < w->capacity) ++bits;
+
+    std::vector<std::uint64_t>& keys = w->pairs;
+    std::vector<std::uint64_t>& out = w->sorted_pairs;
+    out.resize(keys.size());
+
+    std::uint32_t count[MASK + 1];
+    for (int half : {0, 32})
+    {
+        for (int digit = 0; digit < bits; digit += DIGIT)
+        {
+            const int shift = half + digit;
+            std::fill(std::begin(count), std::end(count), 0u);
+            for (std::uint64_t k : keys) ++count[(k >> shift) & MASK];
+
+            std::uint32_t sum = 0;
+            for (std::uint32_t& c : count) sum += std::exchange(c, sum);
+            for (std::uint64_t k : keys) out[count[(k >> shift) & MASK]++] = k;
+            keys.swap(out);
+        }
+    }
+}
+
+/**
+ * Bodies go into every cell their fattened box touches, counting-sorted by
+ * cell hash. A pair sharing several cells is only reported from the cell
+ * holding the corner where their boxes start to overlap.
+ */
+static void broadphase(World* w)
+{
+    const Bodies& b = w->bodies;
+    Grid& g = w->grid;
+    const float margin = 0.5f * w->config.speculative_margin;
+
+    // Every pair needs an awake body, and a world that is all asleep has not moved
+    w->pairs.clear();
+    const bool moving = std::find(b.awake.begin(), b.awake.end(), 1) != b.awake.end();
+    if (!moving && !w->grid_dirty) return;
+    w->grid_dirty = false;
+    g.slack = 0.f;
+
+    if (w->config.cell_size > 0.f)
+    {
+        g.cell_size = w->config.cell_size;
+    }
+    else
+    {
+        float extent = 0.f;
+        std::uint32_t n = 0;
+        for (std::uint32_t i = 0; i < w->capacity; ++i)
+        {
+            if (!b.live[i] || b.type[i] != BodyType::Dynamic) continue;
+            const vec2 size = b.aabb[i].max - b.aabb[i].min;
+            extent += std::max(size.x, size.y);
+            ++n;
+        }
+        if (n > 0) g.cell_size = std::max(2.f * extent / float(n), 1e-3f);
+    }
+    const float inv = 1.f / g.cell_size;
+
+    w->unsorted.clear();
+    g.large.clear();
+    w->is_large.assign(w->capacity, 0);
+    for (std::uint32_t i = 0; i < w->capacity; ++i)
+    {
+        if (!b.live[i]) continue;
+
+        const AABB box = fattened(b, i, margin);
+        const auto x0 = std::int32_t(std::floor(box.min.x * inv));
+        const auto y0 = std::int32_t(std::floor(box.min.y * inv));
+        const auto x1 = std::int32_t(std::floor(box.max.x * inv));
+        const auto y1 = std::int32_t(std::floor(box.max.y * inv));
+        if ((x1 - x0 + 1) * (y1 - y0 + 1) > MAX_CELLS || x1 - x0 >= MAX_CELLS || y1 - y0 >= MAX_CELLS)
+        {
+            g.large.push_back(i);
+            w->is_large[i] = 1;
+            continue;
+        }
+
+        for (std::int32_t y = y0; y <= y1; ++y)
+            for (std::int32_t x = x0; x <= x1; ++x) w->unsorted.push_back({i, x, y});
+    }
+
+    std::uint32_t buckets = 64;
+    while (buckets < 2 * w->unsorted.size()) buckets *= 2;
+    g.mask = buckets - 1;
+
+    g.start.assign(buckets + 1, 0);
+    for (const Grid::Entry& e : w->unsorted) ++g.start[(cell_hash(e.x, e.y) & g.mask) + 1];
+    for (std::uint32_t k = 0; k < buckets; ++k) g.start[k + 1] += g.start[k];
+
+    g.entries.resize(w->unsorted.size());
+    for (const Grid::Entry& e : w->unsorted)
+    {
+        const std::uint32_t bucket = cell_hash(e.x, e.y) & g.mask;
+        // start[bucket] is bumped as entries land and put back below
+        g.entries[g.start[bucket]++] = e;
+    }
+    for (std::uint32_t k = buckets; k > 0; --k) g.start[k] = g.start[k - 1];
+    g.start[0] = 0;
+
+    for (std::uint32_t k = 0; k < buckets; ++k)
+    {
+        for (std::uint32_t p = g.start[k]; p < g.start[k + 1]; ++p)
+        {
+            const Grid::Entry& ep = g.entries[p];
+            for (std::uint32_t q = p + 1; q < g.start[k + 1]; ++q)
+            {
+                const Grid::Entry& eq = g.entries[q];
+                if (ep.x != eq.x || ep.y != eq.y) continue;
+
+                const vec2 corner = glm::max(b.aabb[ep.body].min, b.aabb[eq.body].min) - margin;
+                const auto cx = std::int32_t(std::floor(corner.x * inv));
+                const auto cy = std::int32_t(std::floor(corner.y * inv));
+                if (cx != ep.x || cy != ep.y) continue;
+
+                consider(w, ep.body, eq.body, margin);
+            }
+        }
+    }
+
+    for (std::uint32_t l : g.large)
+    {
+        for (std::uint32_t i = 0; i < w->capacity; ++i)
+        {
+            if (!b.live[i] || i == l || (w->is_large[i] && i < l)) continue;
+            consider(w, l, i, margin);
+        }
+    }
+
+    sort_pairs(w);
+}
+
+// / END BROADPHASE / //
+
+// / QUERIES // /
+
+/**
+ * Slots of the bodies filed under the grid cells a box passes through moving
+ * by translation, sorted. The box is grown by how far bodies may have moved
+ * since they were filed. When the grid is out of date, or the box covers
+ * more cells than there are bodies, every live body is a candidate.
+ */
+static void gather(const World* w, const AABB& box, vec2 translation, std::vector<std::uint32_t>& out)
+{
+    const Bodies& b = w->bodies;
+    const Grid& g = w->grid;
+    out.clear();
+
+    const AABB grown{box.min - g.slack, box.max + g.slack};
+    const vec2 lo = glm::floor(glm::min(grown.min, grown.min + translation) / g.cell_size);
+    const vec2 hi = glm::floor(glm::max(grown.max, grown.max + translation) / g.cell_size);
+    const double cells = (double(hi.x) - double(lo.x) + 1.0) * (double(hi.y) - double(lo.y) + 1.0);
+
+    if (w->grid_dirty || g.start.empty() || cells > double(w->capacity))
+    {
+        for (std::uint32_t i = 0; i < w->capacity; ++i)
+            if (b.live[i]) out.push_back(i);
+        return;
+    }
+
+    const bool moving = translation != vec2(0.f);
+    for (auto y = std::int32_t(lo.y); y <= std::int32_t(hi.y); ++y)
+    {
+        for (auto x = std::int32_t(lo.x); x <= std::int32_t(hi.x); ++x)
+        {
+            // Cells in the corners of the swept bounds are often never crossed
+            const AABB cell{vec2(float(x), float(y)) * g.cell_size, vec2(float(x + 1), float(y + 1)) * g.cell_size};
+            if (moving && !sweep_aabb(grown, translation, cell).hit) continue;
+
+            const std::uint32_t bucket = cell_hash(x, y) & g.mask;
+            for (std::uint32_t p = g.start[bucket]; p < g.start[bucket + 1]; ++p)
+            {
+                const Grid::Entry& e = g.entries[p];
+                if (e.x == x && e.y == y) out.push_back(e.body);
+            }
+        }
+    }
+    out.insert(out.end(), g.large.begin(), g.large.end());
+
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+static QueryHit query_hit(const World* w, std::uint32_t i, const CastHit& hit)
+{
+    return {{i, w->bodies.generation[i]}, w->bodies.owner[i], hit.fraction, hit.point, hit.normal};
+}
+
+bool ray_cast(const World* w, vec2 origin, vec2 translation, QueryHit& out, std::uint32_t mask)
+{
+    thread_local std::vector<std::uint32_t> candidates;
+    gather(w, {origin, origin}, translation, candidates);
+
+    const Bodies& b = w->bodies;
+    bool found = false;
+    for (std::uint32_t i : candidates)
+    {
+        if (!b.live[i] || !(b.category[i] & mask)) continue;
+
+        const CastHit bounds = sweep_aabb({origin, origin}, translation, b.aabb[i]);
+        if (!bounds.hit || (found && bounds.fraction >= out.fraction)) continue;
+
+        const CastHit hit = ray_cast(b.shape[i], b.position[i], b.rot[i], origin, translation);
+        if (!hit.hit || (found && hit.fraction >= out.fraction)) continue;
+
+        out = query_hit(w, i, hit);
+        found = true;
+    }
+    return found;
+}
+
+bool shape_cast(const World* w, const Shape& shape, vec2 position, float angle, vec2 translation, QueryHit& out,
+                std::uint32_t mask)
+{
+    thread_local std::vector<std::uint32_t> candidates;
+    const AABB box = compute_aabb(shape, position, rotation(angle));
+    gather(w, box, translation, candidates);
+
+    const Bodies& b = w->bodies;
+    const Sweep sweep{position, position + translation, angle, angle};
+    bool found = false;
+    for (std::uint32_t i : candidates)
+    {
+        if (!b.live[i] || !(b.category[i] & mask)) continue;
+
+        const CastHit bounds = sweep_aabb(box, translation, b.aabb[i]);
+        if (!bounds.hit || (found && bounds.fraction >= out.fraction)) continue;
+
+        const Sweep still{b.position[i], b.position[i], b.angle[i], b.angle[i]};
+        const CastHit hit = time_of_impact(shape, sweep, b.shape[i], still, 0.f);
+        if (!hit.hit || (found && hit.fraction >= out.fraction)) continue;
+
+        out = query_hit(w, i, hit);
+        found = true;
+    }
+    return found;
+}
+
+bool circle_cast(const World* w, vec2 centre, float radius, vec2 translation, QueryHit& out, std::uint32_t mask)
+{
+    return shape_cast(w, circle(radius), centre, 0.f, translation, out, mask);
+}
+
+void query_aabb(const World* w, const AABB& box, std::vector<BodyId>& out, std::uint32_t mask)
+{
+    thread_local std::vector<std::uint32_t> candidates;
+    gather(w, box, vec2(0.f), candidates);
+
+    const Bodies& b = w->bodies;
+    for (std::uint32_t i : candidates)
+    {
+        if (b.live[i] && (b.category[i] & mask) && overlaps(b.aabb[i], box)) out.push_back({i, b.generation[i]});
+    }
+}
+
+bool ray_cast(ECS& ecs, vec2 origin, vec2 translation, QueryHit& out, std::uint32_t mask)
+{
+    const World* w = get_world(ecs);
+    return w && ray_cast(w, origin, translation, out, mask);
+}
+
+bool shape_cast(ECS& ecs, const Shape& shape, vec2 position, float angle, vec2 translation, QueryHit& out,
+                std::uint32_t mask)
+{
+    const World* w = get_world(ecs);
+    return w && shape_cast(w, shape, position, angle, translation, out, mask);
+}
+
+bool circle_cast(ECS& ecs, vec2 centre, float radius, vec2 translation, QueryHit& out, std::uint32_t mask)
+{
+    const World* w = get_world(ecs);
+    return w && circle_cast(w, centre, radius, translation, out, mask);
+}
+
+void query_aabb(ECS& ecs, const AABB& box, std::vector<BodyId>& out, std::uint32_t mask)
+{
+    if (const World* w = get_world(ecs)) query_aabb(w, box, out, mask);
+}
+
+// / END QUERIES / //
+
+/**
+ * Collide every pair, then merge the results with last step's contacts so
+ * points that survive keep their impulses. Contacts between bodies that are
+ * both asleep or static are not in the pair list and are carried over as
+ * they are; nothing has moved them.
+ */
+static void narrowphase(World* w)
+{
+    const Bodies& b = w->bodies;
+    const float margin = w->config.speculative_margin;
+
+    const auto count = static_cast<std::uint32_t>(w->pairs.size());
+    w->manifolds.resize(count);
+    parallel_for(w->config.worker_threads, (count + NARROWPHASE_CHUNK - 1) / NARROWPHASE_CHUNK,
+                 [w, &b, margin, count](std::uint32_t chunk)
+                 {
+                     const std::uint32_t end = std::min(count, (chunk + 1) * NARROWPHASE_CHUNK);
+                     for (std::uint32_t k = chunk * NARROWPHASE_CHUNK; k < end; ++k)
+                     {
+                         const auto i = std::uint32_t(w->pairs[k] >> 32);
+                         const auto j = std::uint32_t(w->pairs[k]);
+                         w->manifolds[k] = collide(b.shape[i], b.position[i], b.rot[i], b.shape[j], b.position[j],
+                                                   b.rot[j], margin);
+                     }
+                 });
+
+    auto resting = [&b](const Contact& c) { return !b.awake[c.a] && !b.awake[c.b]; };
+
+    w->merged.clear();
+    std::size_t old = 0;
+    for (std::uint32_t k = 0; k < count; ++k)
+    {
+        const std::uint64_t key = w->pairs[k];
+        while (old < w->contacts.size() && pair_key(w->contacts[old].a, w->contacts[old].b) < key)
+        {
+            if (resting(w->contacts[old])) w->merged.push_back(w->contacts[old]);
+            ++old;
+        }
+
+        const Contact* previous = nullptr;
+        if (old < w->contacts.size() && pair_key(w->contacts[old].a, w->contacts[old].b) == key)
+            previous = &w->contacts[old++];
+
+        const Manifold& m = w->manifolds[k];
+        if (m.count == 0) continue;
+
+        Contact& c = w->merged.emplace_back();
+        c.a = std::uint32_t(key >> 32);
+        c.b = std::uint32_t(key);
+        c.manifold = m;
+        c.friction = std::sqrt(b.friction[c.a] * b.friction[c.b]);
+        c.restitution = std::max(b.restitution[c.a], b.restitution[c.b]);
+
+        if (!previous) continue;
+        for (int p = 0; p < m.count; ++p)
+        {
+            for (int q = 0; q < previous->manifold.count; ++q)
+            {
+                if (previous->manifold.points[q].id != m.points[p].id) continue;
+                c.normal_impulse[p] = previous->normal_impulse[q];
+                c.tangent_impulse[p] = previous->tangent_impulse[q];
+                break;
+            }
+        }
+    }
+    for (; old < w->contacts.size(); ++old)
+        if (resting(w->contacts[old])) w->merged.push_back(w->contacts[old]);
+
+    std::swap(w->contacts, w->merged);
+
+    // Anything awake touching a sleeping island wakes all of it, contacts included
+    for (const Contact& c : w->contacts)
+    {
+        if (w->bodies.awake[c.a] == w->bodies.awake[c.b]) continue;
+        wake_body(w, w->bodies.awake[c.a] ? c.b : c.a);
+    }
+}
+
+static void integrate_velocities(World* w, float dt)
+{
+    Bodies& b = w->bodies;
+    const vec2 gravity = w->config.gravity;
+
+    for (std::uint32_t i = 0; i < w->capacity; ++i)
+    {
+        if (!b.awake[i] || b.type[i] != BodyType::Dynamic) continue;
+
+        vec2 v = b.velocity[i] + dt * (b.gravity_scale[i] * gravity + b.inv_mass[i] * b.force[i]);
+        float av = b.angular_velocity[i] + dt * b.inv_inertia[i] * b.torque[i];
+        v *= 1.f / (1.f + dt * b.linear_damping[i]);
+        av *= 1.f / (1.f + dt * b.angular_damping[i]);
+
+        b.velocity[i] = v;
+        b.angular_velocity[i] = av;
+        b.force[i] = vec2(0.f);
+        b.torque[i] = 0.f;
+    }
+}
+
+// / ISLANDS // /
+
+static std::uint32_t find_root(std::vector<std::uint32_t>& parent, std::uint32_t i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+static bool solved(const Bodies& b, std::uint32_t i) { return b.awake[i] && b.type[i] == BodyType::Dynamic; }
+
+/**
+ * Union-find over awake dynamic bodies joined by contacts. Static and
+ * kinematic bodies never join islands, otherwise everything on the ground
+ * would be one island. Bodies and contacts are then bucketed per island.
+ */
+static std::uint32_t build_islands(World* w)
+{
+    const Bodies& b = w->bodies;
+    std::vector<std::uint32_t>& parent = w->parent;
+
+    parent.resize(w->capacity);
+    for (std::uint32_t i = 0; i < w->capacity; ++i) parent[i] = i;
+
+    for (const Contact& c : w->contacts)
+    {
+        if (!solved(b, c.a) || !solved(b, c.b)) continue;
+        const std::uint32_t ra = find_root(parent, c.a);
+        const std::uint32_t rb = find_root(parent, c.b);
+        if (ra != rb) parent[std::max(ra, rb)] = std::min(ra, rb);
+    }
+
+    std::uint32_t islands = 0;
+    w->island_of.assign(w->capacity, NONE);
+    for (std::uint32_t i = 0; i < w->capacity; ++i)
+    {
+        if (!solved(b, i)) continue;
+        const std::uint32_t root = find_root(parent, i);
+        if (w->island_of[root] == NONE) w->island_of[root] = islands++;
+        w->island_of[i] = w->island_of[root];
+    }
+
+    w->island_start.assign(islands + 1, 0);
+    for (std::uint32_t i = 0; i < w->capacity; ++i)
+        if (w->island_of[i] != NONE) ++w->island_start[w->island_of[i] + 1];
+    for (std::uint32_t k = 0; k < islands; ++k) w->island_start[k + 1] += w->island_start[k];
+
+    w->island_bodies.resize(w->island_start[islands]);
+    w->parent.assign(w->island_start.begin(), w->island_start.end() - 1);  // Reused as write cursors
+    for (std::uint32_t i = 0; i < w->capacity; ++i)
+        if (w->island_of[i] != NONE) w->island_bodies[w->parent[w->island_of[i]]++] = i;
+
+    auto island_of_contact = [w, &b](const Contact& c)
+    { return solved(b, c.a) ? w->island_of[c.a] : solved(b, c.b) ? w->island_of[c.b] : NONE; };
+
+    w->contact_start.assign(islands + 1, 0);
+    for (const Contact& c : w->contacts)
+        if (const std::uint32_t k = island_of_contact(c); k != NONE) ++w->contact_start[k + 1];
+    for (std::uint32_t k = 0; k < islands; ++k) w->contact_start[k + 1] += w->contact_start[k];
+
+    w->island_contacts.resize(w->contact_start[islands]);
+    w->parent.assign(w->contact_start.begin(), w->contact_start.end() - 1);
+    for (std::uint32_t n = 0; n < w->contacts.size(); ++n)
+        if (const std::uint32_t k = island_of_contact(w->contacts[n]); k != NONE)
+            w->island_contacts[w->parent[k]++] = n;
+
+    return islands;
+}
+
+// / END ISLANDS / //
+
+// / SOLVER // /
+
+struct SolverBody
+{
+    vec2 v;
+    float w;
+    float inv_mass;
+    float inv_inertia;
+};
+
+struct SolverPoint
+{
+    vec2 ra, rb;
+    float normal_mass;
+    float tangent_mass;
+    float bias;
+    float relax_bias;  // Without the overlap push
+    float normal_impulse;
+    float tangent_impulse;
+};
+
+struct SolverContact
+{
+    std::uint32_t a, b;  // Into the island's SolverBody array
+    vec2 normal;
+    float friction;
+    int count;
+    SolverPoint points[2];
+
+    // Two point manifolds solve their normal impulses together: K and its inverse
+    bool block;
+    float k11, k12, k22;
+    float m11, m12, m22;
+};
+
+struct SolverScratch
+{
+    std::vector<SolverBody> bodies;
+    std::vector<SolverContact> constraints;
+    std::vector<std::uint32_t> local;  // Island position of each body slot
+};
+
+static void apply(SolverBody& a, SolverBody& b, const SolverPoint& p, vec2 impulse)
+{
+    a.v -= a.inv_mass * impulse;
+    a.w -= a.inv_inertia * cross(p.ra, impulse);
+    b.v += b.inv_mass * impulse;
+    b.w += b.inv_inertia * cross(p.rb, impulse);
+}
+
+static vec2 relative_velocity(const SolverBody& a, const SolverBody& b, const SolverPoint& p)
+{
+    return b.v + cross(b.w, p.rb) - a.v - cross(a.w, p.ra);
+}
+
+/**
+ * Exact solution of the 2x2 LCP for both normal impulses, trying each set of
+ * active points in turn. Solving the points one after the other instead makes
+ * a resting box rock, which tall stacks amplify.
+ */
+static void solve_block(SolverBody& ba, SolverBody& bb, SolverContact& sc, bool relax)
+{
+    SolverPoint& p1 = sc.points[0];
+    SolverPoint& p2 = sc.points[1];
+    const float a1 = p1.normal_impulse;
+    const float a2 = p2.normal_impulse;
+    const float bias1 = relax ? p1.relax_bias : p1.bias;
+    const float bias2 = relax ? p2.relax_bias : p2.bias;
+
+    const float b1 = glm::dot(relative_velocity(ba, bb, p1), sc.normal) - bias1 - (sc.k11 * a1 + sc.k12 * a2);
+    const float b2 = glm::dot(relative_velocity(ba, bb, p2), sc.normal) - bias2 - (sc.k12 * a1 + sc.k22 * a2);
+
+    float x1 = -(sc.m11 * b1 + sc.m12 * b2);
+    float x2 = -(sc.m12 * b1 + sc.m22 * b2);
+    if (x1 < 0.f || x2 < 0.f)
+    {
+        x1 = -p1.normal_mass * b1;
+        x2 = 0.f;
+        if (x1 < 0.f || sc.k12 * x1 + b2 < 0.f)
+        {
+            x1 = 0.f;
+            x2 = -p2.normal_mass * b2;
+            if (x2 < 0.f || sc.k12 * x2 + b1 < 0.f)
+            {
+                // Neither point pushing is the last candidate; otherwise keep last iteration's impulses
+                if (b1 < 0.f || b2 < 0.f) return;
+                x1 = 0.f;
+                x2 = 0.f;
+            }
+        }
+    }
+
+    apply(ba, bb, p1, (x1 - a1) * sc.normal);
+    apply(ba, bb, p2, (x2 - a2) * sc.normal);
+    p1.normal_impulse = x1;
+    p2.normal_impulse = x2;
+}
+
+static void solve_contacts(std::vector<SolverBody>& bodies, std::vector<SolverContact>& constraints, bool relax)
+{
+    for (SolverContact& sc : constraints)
+    {
+        // Copies, so the velocities stay in registers instead of being reloaded after every impulse store
+        SolverBody ba = bodies[sc.a];
+        SolverBody bb = bodies[sc.b];
+        const vec2 tangent(sc.normal.y, -sc.normal.x);
+
+        for (int k = 0; k < sc.count; ++k)
+        {
+            SolverPoint& p = sc.points[k];
+            const float vt = glm::dot(relative_velocity(ba, bb, p), tangent);
+            const float limit = sc.friction * p.normal_impulse;
+            const float total = std::clamp(p.tangent_impulse - p.tangent_mass * vt, -limit, limit);
+            const float lambda = total - p.tangent_impulse;
+            p.tangent_impulse = total;
+            apply(ba, bb, p, lambda * tangent);
+        }
+
+        if (sc.block)
+        {
+            solve_block(ba, bb, sc, relax);
+        }
+        else
+        {
+            for (int k = 0; k < sc.count; ++k)
+            {
+                SolverPoint& p = sc.points[k];
+                const float vn = glm::dot(relative_velocity(ba, bb, p), sc.normal);
+                const float bias = relax ? p.relax_bias : p.bias;
+                const float total = std::max(p.normal_impulse + p.normal_mass * (bias - vn), 0.f);
+                const float lambda = total - p.normal_impulse;
+                p.normal_impulse = total;
+                apply(ba, bb, p, lambda * sc.normal);
+            }
+        }
+
+        bodies[sc.a] = ba;
+        bodies[sc.b] = bb;
+    }
+}
+
+/**
+ * A body that moved far enough this step to have passed through something
+ * thin is swept against the static bodies along its path, and pulled back
+ * to where it first came within linear_slop of one. Its velocity is kept;
+ * next step's speculative contact stops it.
+ */
+static void continuous(World* w, std::uint32_t i, const Sweep& sweep)
+{
+    Bodies& b = w->bodies;
+    const float travel = glm::length(sweep.p1 - sweep.p0) + std::abs(sweep.a1 - sweep.a0) * b.max_extent[i];
+    if (travel < 0.5f * b.min_extent[i]) return;
+
+    const AABB start = compute_aabb(b.shape[i], sweep.p0, rotation(sweep.a0));
+    const AABB end = compute_aabb(b.shape[i], sweep.p1, rotation(sweep.a1));
+    const AABB bounds{glm::min(start.min, end.min), glm::max(start.max, end.max)};
+
+    thread_local std::vector<std::uint32_t> candidates;
+    gather(w, bounds, vec2(0.f), candidates);
+
+    float t = 1.f;
+    for (std::uint32_t j : candidates)
+    {
+        if (b.type[j] != BodyType::Static || !(b.category[i] & b.mask[j]) || !(b.category[j] & b.mask[i])) continue;
+        if (!overlaps(bounds, b.aabb[j])) continue;
+
+        const Sweep still{b.position[j], b.position[j], b.angle[j], b.angle[j]};
+        const CastHit hit = time_of_impact(b.shape[i], sweep, b.shape[j], still, w->config.linear_slop);
+
+        if (hit.hit && hit.fraction > 0.f)
+        {
+            t = std::min(t, hit.fraction);
+            continue;
+        }
+
+        // Touching at the start is the discrete contact's job, and a sweep that ran out of iterations is left
+        // alone too, as long as the centre does not go through
+        const vec2 path = sweep.p1 - sweep.p0;
+        const CastHit centre = ray_cast(b.shape[j], b.position[j], b.rot[j], sweep.p0, path);
+        if (centre.hit) t = std::min(t, std::max(0.f, centre.fraction - b.min_extent[i] / glm::length(path)));
+    }
+
+    if (t < 1.f)
+    {
+        b.position[i] = glm::mix(sweep.p0, sweep.p1, t);
+        b.angle[i] = glm::mix(sweep.a0, sweep.a1, t);
+    }
+}
+
+/**
+ * Sequential impulses over one island, warm started, then position
+ * integration and the island's sleep timer. Touches only the island's own
+ * bodies and contacts, so islands can run on any thread.
+ */
+static void solve_island(World* w, std::uint32_t island, float dt)
+{
+    // Per thread, bound once: every access to a thread_local goes through its init guard
+    thread_local SolverScratch scratch;
+    std::vector<SolverBody>& bodies = scratch.bodies;
+    std::vector<SolverContact>& constraints = scratch.constraints;
+    std::vector<std::uint32_t>& local = scratch.local;
+
+    Bodies& b = w->bodies;
+    const Config& cfg = w->config;
+    const float inv_dt = 1.f / dt;
+
+    const std::uint32_t* members = w->island_bodies.data() + w->island_start[island];
+    const std::uint32_t member_count = w->island_start[island + 1] - w->island_start[island];
+    const std::uint32_t* contacts = w->island_contacts.data() + w->contact_start[island];
+    const std::uint32_t contact_count = w->contact_start[island + 1] - w->contact_start[island];
+
+    bodies.clear();
+    if (local.size() < w->capacity) local.resize(w->capacity);
+    for (std::uint32_t n = 0; n < member_count; ++n)
+    {
+        const std::uint32_t i = members[n];
+        local[i] = n;
+        bodies.push_back({b.velocity[i], b.angular_velocity[i], b.inv_mass[i], b.inv_inertia[i]});
+    }
+
+    // Static and kinematic partners get a private copy with no mass, so solving never writes them
+    auto body_index = [&](std::uint32_t i)
+    {
+        if (solved(b, i)) return local[i];
+        bodies.push_back({b.velocity[i], b.angular_velocity[i], 0.f, 0.f});
+        return std::uint32_t(bodies.size() - 1);
+    };
+
+    constraints.clear();
+    for (std::uint32_t n = 0; n < contact_count; ++n)
+    {
+        const Contact& c = w->contacts[contacts[n]];
+        SolverContact& sc = constraints.emplace_back();
+        sc.a = body_index(c.a);
+        sc.b = body_index(c.b);
+        sc.normal = c.manifold.normal;
+        sc.friction = c.friction;
+        sc.count = c.manifold.count;
+
+        const SolverBody& ba = bodies[sc.a];
+        const SolverBody& bb = bodies[sc.b];
+        const vec2 tangent(sc.normal.y, -sc.normal.x);
+
+        for (int k = 0; k < sc.count; ++k)
+        {
+            const ManifoldPoint& mp = c.manifold.points[k];
+            SolverPoint& p = sc.points[k];
+            p.ra = mp.point - b.position[c.a];
+            p.rb = mp.point - b.position[c.b];
+
+            const float rna = cross(p.ra, sc.normal);
+            const float rnb = cross(p.rb, sc.normal);
+            const float kn = ba.inv_mass + bb.inv_mass + ba.inv_inertia * rna * rna + bb.inv_inertia * rnb * rnb;
+            p.normal_mass = kn > 0.f ? 1.f / kn : 0.f;
+
+            const float rta = cross(p.ra, tangent);
+            const float rtb = cross(p.rb, tangent);
+            const float kt = ba.inv_mass + bb.inv_mass + ba.inv_inertia * rta * rta + bb.inv_inertia * rtb * rtb;
+            p.tangent_mass = kt > 0.f ? 1.f / kt : 0.f;
+
+            // Speculative points may close their gap this step; overlapping ones are pushed apart gently
+            p.relax_bias = mp.separation > 0.f ? -mp.separation * inv_dt : 0.f;
+            p.bias = p.relax_bias + cfg.baumgarte * inv_dt * std::max(0.f, -mp.separation - cfg.linear_slop);
+
+            const float vn = glm::dot(relative_velocity(ba, bb, p), sc.normal);
+            if (c.restitution > 0.f && vn < -cfg.restitution_threshold)
+            {
+                p.relax_bias = std::max(p.relax_bias, -c.restitution * vn);
+                p.bias = std::max(p.bias, p.relax_bias);
+            }
+
+            p.normal_impulse = c.normal_impulse[k];
+            p.tangent_impulse = c.tangent_impulse[k];
+        }
+
+        sc.block = false;
+        if (sc.count == 2)
+        {
+            const float rn1a = cross(sc.points[0].ra, sc.normal);
+            const float rn1b = cross(sc.points[0].rb, sc.normal);
+            const float rn2a = cross(sc.points[1].ra, sc.normal);
+            const float rn2b = cross(sc.points[1].rb, sc.normal);
+            const float m = ba.inv_mass + bb.inv_mass;
+
+            sc.k11 = m + ba.inv_inertia * rn1a * rn1a + bb.inv_inertia * rn1b * rn1b;
+            sc.k22 = m + ba.inv_inertia * rn2a * rn2a + bb.inv_inertia * rn2b * rn2b;
+            sc.k12 = m + ba.inv_inertia * rn1a * rn2a + bb.inv_inertia * rn1b * rn2b;
+
+            // Points too close together make K near singular; those fall back to one at a time
+            const float det = sc.k11 * sc.k22 - sc.k12 * sc.k12;
+            if (sc.k11 * sc.k11 < 1000.f * det)
+            {
+                sc.block = true;
+                sc.m11 = sc.k22 / det;
+                sc.m12 = -sc.k12 / det;
+                sc.m22 = sc.k11 / det;
+            }
+        }
+    }
+
+    for (SolverContact& sc : constraints)
+    {
+        const vec2 tangent(sc.normal.y, -sc.normal.x);
+        for (int k = 0; k < sc.count; ++k)
+        {
+            const SolverPoint& p = sc.points[k];
+            apply(bodies[sc.a], bodies[sc.b], p, p.normal_impulse * sc.normal + p.tangent_impulse * tangent);
+        }
+    }
+
+    for (int iteration = 0; iteration < cfg.velocity_iterations; ++iteration)
+        solve_contacts(bodies, constraints, false);
+
+    // Positions move with the biased velocities, which is what pushes overlap apart...
+    float motion = 0.f;
+    for (std::uint32_t n = 0; n < member_count; ++n)
+    {
+        // More than an eighth of a turn per step and contacts lose track of which way things are facing
+        bodies[n].w = std::clamp(bodies[n].w, -MAX_ROTATION * inv_dt, MAX_ROTATION * inv_dt);
+
+        const std::uint32_t i = members[n];
+        const Sweep sweep{b.position[i], b.position[i] + dt * bodies[n].v, b.angle[i], b.angle[i] + dt * bodies[n].w};
+        b.position[i] = sweep.p1;
+        b.angle[i] = sweep.a1;
+        if (cfg.continuous) continuous(w, i, sweep);
+
+        const float turned = std::abs(b.angle[i] - sweep.a0) * b.max_extent[i];
+        motion = std::max(motion, glm::length(b.position[i] - sweep.p0) + turned);
+    }
+    w->island_motion[island] = motion;
+
+    // ...but the velocities kept are relaxed without the bias, so the push does not carry into the next step
+    for (int iteration = 0; iteration < cfg.relax_iterations; ++iteration) solve_contacts(bodies, constraints, true);
+
+    for (std::uint32_t n = 0; n < contact_count; ++n)
+    {
+        Contact& c = w->contacts[contacts[n]];
+        for (int k = 0; k < constraints[n].count; ++k)
+        {
+            c.normal_impulse[k] = constraints[n].points[k].normal_impulse;
+            c.tangent_impulse[k] = constraints[n].points[k].tangent_impulse;
+        }
+    }
+
+    const float linear_tolerance = cfg.sleep_linear_velocity * cfg.sleep_linear_velocity;
+    float min_sleep = cfg.time_to_sleep;
+    for (std::uint32_t n = 0; n < member_count; ++n)
+    {
+        const std::uint32_t i = members[n];
+        const vec2 v = bodies[n].v;
+        const float av = bodies[n].w;
+
+        b.velocity[i] = v;
+        b.angular_velocity[i] = av;
+        b.rot[i] = rotation(b.angle[i]);
+        b.aabb[i] = compute_aabb(b.shape[i], b.position[i], b.rot[i]);
+
+        if (glm::dot(v, v) > linear_tolerance || std::abs(av) > cfg.sleep_angular_velocity)
+            b.sleep_time[i] = 0.f;
+        else
+            b.sleep_time[i] += dt;
+        min_sleep = std::min(min_sleep, b.sleep_time[i]);
+    }
+    w->island_sleep[island] = min_sleep;
+}
+
+// / END SOLVER / //
+
+static void put_to_sleep(World* w, std::uint32_t island)
+{
+    Bodies& b = w->bodies;
+
+    std::uint32_t id;
+    if (!w->free_islands.empty())
+    {
+        id = w->free_islands.back();
+        w->free_islands.pop_back();
+    }
+    else
+    {
+        id = static_cast<std::uint32_t>(w->sleeping.size());
+        w->sleeping.emplace_back();
+    }
+
+    std::vector<std::uint32_t>& members = w->sleeping[id];
+    members.assign(w->island_bodies.begin() + w->island_start[island],
+                   w->island_bodies.begin() + w->island_start[island + 1]);
+    for (std::uint32_t i : members)
+    {
+        b.awake[i] = 0;
+        b.velocity[i] = vec2(0.f);
+        b.angular_velocity[i] = 0.f;
+        b.sleep_island[i] = id;
+    }
+}
+
+// Bodies whose entity was destroyed go with it
+static void reap(World* w, ECS* ecs)
+{
+    const Bodies& b = w->bodies;
+    for (std::uint32_t i = 0; i < w->capacity; ++i)
+    {
+        if (b.live[i] && b.owner[i] != entt::null && !ecs->valid(b.owner[i]))
+            destroy_body(w, {i, b.generation[i]});
+    }
+}
+
+static void write_poses(World* w, ECS* ecs)
+{
+    const Bodies& b = w->bodies;
+    for (Entity e : ecs->view<Body, Pose>())
+    {
+        std::uint32_t i;
+        if (!slot(w, e.get<Body>().id, i) || (b.type[i] == BodyType::Dynamic && !b.awake[i])) continue;
+        e.get<Pose>() = {b.position[i], b.angle[i]};
+    }
+}
+
+void step(World* w, float dt, ECS* ecs)
+{
+    if (dt <= 0.f) return;
+
+    const auto start = std::chrono::steady_clock::now();
+    Bodies& b = w->bodies;
+    if (ecs) reap(w, ecs);
+
+    broadphase(w);
+    w->stats.broadphase_ns = elapsed_ns(start);
+
+    const auto narrow_start = std::chrono::steady_clock::now();
+    narrowphase(w);
+    w->stats.narrowphase_ns = elapsed_ns(narrow_start);
+
+    const auto solve_start = std::chrono::steady_clock::now();
+    integrate_velocities(w, dt);
+    const std::uint32_t islands = build_islands(w);
+    w->island_sleep.resize(islands);
+    w->island_motion.resize(islands);
+    parallel_for(w->config.worker_threads, islands, [w, dt](std::uint32_t k) { solve_island(w, k, dt); });
+
+    float motion = 0.f;
+    for (std::uint32_t k = 0; k < islands; ++k) motion = std::max(motion, w->island_motion[k]);
+
+    for (std::uint32_t i = 0; i < w->capacity; ++i)
+    {
+        if (!b.live[i] || b.type[i] != BodyType::Kinematic || !b.awake[i]) continue;
+        b.position[i] += dt * b.velocity[i];
+        b.angle[i] += dt * b.angular_velocity[i];
+        b.rot[i] = rotation(b.angle[i]);
+        b.aabb[i] = compute_aabb(b.shape[i], b.position[i], b.rot[i]);
+        const float turned = std::abs(b.angular_velocity[i]) * b.max_extent[i];
+        motion = std::max(motion, dt * (glm::length(b.velocity[i]) + turned));
+    }
+    // Queries widen their search by this until the next rebuild
+    w->grid.slack += motion;
+
+    // Before sleeping, so bodies falling asleep get their final pose
+    if (ecs) write_poses(w, ecs);
+
+    if (w->config.allow_sleep)
+    {
+        for (std::uint32_t k = 0; k < islands; ++k)
+            if (w->island_sleep[k] >= w->config.time_to_sleep) put_to_sleep(w, k);
+    }
+    w->stats.solve_ns = elapsed_ns(solve_start);
+
+    Stats& s = w->stats;
+    s.bodies = w->capacity - static_cast<std::uint32_t>(w->free_slots.size());
+    // Counted after the sleep pass, island_bodies still holds islands that just fell asleep
+    s.awake = 0;
+    for (std::uint32_t i = 0; i < w->capacity; ++i)
+        if (w->bodies.live[i] && solved(w->bodies, i)) ++s.awake;
+    s.pairs = static_cast<std::uint32_t>(w->pairs.size());
+    s.contacts = static_cast<std::uint32_t>(w->contacts.size());
+    s.islands = islands;
+    s.sleeping_islands = static_cast<std::uint32_t>(w->sleeping.size() - w->free_islands.size());
+    s.step_ns = elapsed_ns(start);
+}
+
+void step(ECS& ecs, float dt)
+{
+    if (World* w = get_world(ecs)) step(w, dt, &ecs);
+}
+
+}  // namespace kine::physics
@@ -0,0 +1,530 @@
+#include "kine/physics/shapes.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+#include "kine/log.hpp"
+
+namespace kine::physics
+{
+
+// Keeps the reference face from flip-flopping between two near-equal candidates; world units
+static constexpr float FACE_TOLERANCE = 0.05f;
+// Time of impact stops this close above its target; world units
+static constexpr float TOI_TOLERANCE = 0.1f;
+static constexpr int TOI_ITERATIONS = 30;
+
+static void finish_polygon(Shape& s)
+{
+    // Recentre on the centroid, so the body position is the centre of mass
+    vec2 centroid{0.f};
+    float area = 0.f;
+    for (int i = 1; i + 1 < s.count; ++i)
+    {
+        const vec2 e1 = s.vertices[i] - s.vertices[0];
+        const vec2 e2 = s.vertices[i + 1] - s.vertices[0];
+        const float a = 0.5f * cross(e1, e2);
+        centroid += a * (s.vertices[0] + s.vertices[i] + s.vertices[i + 1]) / 3.f;
+        area += a;
+    }
+    centroid /= area;
+
+    for (int i = 0; i < s.count; ++i) s.vertices[i] -= centroid;
+    for (int i = 0; i < s.count; ++i)
+    {
+        const vec2 edge = s.vertices[(i + 1) % s.count] - s.vertices[i];
+        s.normals[i] = glm::normalize(vec2(edge.y, -edge.x));
+    }
+}
+
+Shape circle(float radius)
+{
+    Shape s;
+    s.type = ShapeType::Circle;
+    s.radius = radius;
+    return s;
+}
+
+Shape box(vec2 half_extents)
+{
+    Shape s;
+    s.count = 4;
+    s.vertices[0] = {-half_extents.x, -half_extents.y};
+    s.vertices[1] = {half_extents.x, -half_extents.y};
+    s.vertices[2] = {half_extents.x, half_extents.y};
+    s.vertices[3] = {-half_extents.x, half_extents.y};
+    s.normals = {vec2(0.f, -1.f), vec2(1.f, 0.f), vec2(0.f, 1.f), vec2(-1.f, 0.f)};
+    return s;
+}
+
+Shape polygon(std::span<const vec2> points)
+{
+    // Monotone chain; the lower then upper hull come out with positive winding
+    std::vector<vec2> sorted(points.begin(), points.end());
+    std::sort(sorted.begin(), sorted.end(), [](vec2 a, vec2 b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+
+    std::vector<vec2> hull;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        const std::size_t base = hull.size();
+        for (const vec2 p : sorted)
+        {
+            while (hull.size() >= base + 2 && cross(hull.back() - hull[hull.size() - 2], p - hull.back()) <= 1e-6f)
+                hull.pop_back();
+            hull.push_back(p);
+        }
+        hull.pop_back();
+        std::reverse(sorted.begin(), sorted.end());
+    }
+
+    if (hull.size() < 3 || hull.size() > MAX_POLYGON_VERTICES)
+    {
+        LOG_ERROR("Physics: polygon hull has {} vertices, expected 3 to {}", hull.size(), MAX_POLYGON_VERTICES);
+        return box(vec2(0.5f));
+    }
+
+    Shape s;
+    s.count = static_cast<int>(hull.size());
+    std::copy(hull.begin(), hull.end(), s.vertices.begin());
+    finish_polygon(s);
+    return s;
+}
+
+MassData compute_mass(const Shape& shape, float density)
+{
+    if (shape.type == ShapeType::Circle)
+    {
+        const float mass = density * 3.1415927f * shape.radius * shape.radius;
+        return {mass, 0.5f * mass * shape.radius * shape.radius};
+    }
+
+    // Triangle fan around the centroid, which is the origin
+    float area = 0.f;
+    float inertia = 0.f;
+    for (int i = 0; i < shape.count; ++i)
+    {
+        const vec2 e1 = shape.vertices[i];
+        const vec2 e2 = shape.vertices[(i + 1) % shape.count];
+        const float d = cross(e1, e2);
+        area += 0.5f * d;
+
+        const float xx = e1.x * e1.x + e2.x * e1.x + e2.x * e2.x;
+        const float yy = e1.y * e1.y + e2.y * e1.y + e2.y * e2.y;
+        inertia += (0.25f / 3.f) * d * (xx + yy);
+    }
+    return {density * area, density * inertia};
+}
+
+AABB compute_aabb(const Shape& shape, vec2 position, Rotation r)
+{
+    if (shape.type == ShapeType::Circle) return {position - shape.radius, position + shape.radius};
+
+    AABB box{vec2(FLT_MAX), vec2(-FLT_MAX)};
+    for (int i = 0; i < shape.count; ++i)
+    {
+        const vec2 v = position + rotate(r, shape.vertices[i]);
+        box.min = glm::min(box.min, v);
+        box.max = glm::max(box.max, v);
+    }
+    return box;
+}
+
+float min_extent(const Shape& shape)
+{
+    if (shape.type == ShapeType::Circle) return shape.radius;
+
+    float extent = FLT_MAX;
+    for (int i = 0; i < shape.count; ++i) extent = std::min(extent, glm::dot(shape.normals[i], shape.vertices[i]));
+    return extent;
+}
+
+float max_extent(const Shape& shape)
+{
+    if (shape.type == ShapeType::Circle) return shape.radius;
+
+    float extent = 0.f;
+    for (int i = 0; i < shape.count; ++i) extent = std::max(extent, glm::length(shape.vertices[i]));
+    return extent;
+}
+
+struct WorldPolygon
+{
+    int count = 0;
+    vec2 v[MAX_POLYGON_VERTICES];
+    vec2 n[MAX_POLYGON_VERTICES];
+};
+
+static WorldPolygon to_world(const Shape& s, vec2 p, Rotation r)
+{
+    WorldPolygon w;
+    w.count = s.count;
+    for (int i = 0; i < s.count; ++i)
+    {
+        w.v[i] = p + rotate(r, s.vertices[i]);
+        w.n[i] = rotate(r, s.normals[i]);
+    }
+    return w;
+}
+
+// Largest distance of b's deepest vertex in front of one of a's edges
+static float max_separation(const WorldPolygon& a, const WorldPolygon& b, int& edge)
+{
+    float best = -FLT_MAX;
+    for (int i = 0; i < a.count; ++i)
+    {
+        float s = FLT_MAX;
+        for (int j = 0; j < b.count; ++j) s = std::min(s, glm::dot(a.n[i], b.v[j] - a.v[i]));
+        if (s > best)
+        {
+            best = s;
+            edge = i;
+        }
+    }
+    return best;
+}
+
+struct ClipVertex
+{
+    vec2 p;
+    std::uint32_t id;
+};
+
+// Keep the part of the segment where dot(normal, p) <= offset
+static int clip(const ClipVertex in[2], ClipVertex out[2], vec2 normal, float offset, std::uint32_t clip_id)
+{
+    int n = 0;
+    const float d0 = glm::dot(normal, in[0].p) - offset;
+    const float d1 = glm::dot(normal, in[1].p) - offset;
+    if (d0 <= 0.f) out[n++] = in[0];
+    if (d1 <= 0.f) out[n++] = in[1];
+    if (d0 * d1 < 0.f) out[n++] = {in[0].p + (d0 / (d0 - d1)) * (in[1].p - in[0].p), clip_id};
+    return n;
+}
+
+/**
+ * SAT for the reference face, then the most anti-parallel edge of the other
+ * polygon clipped against the reference face's side planes.
+ */
+static Manifold collide_polygons(const WorldPolygon& a, const WorldPolygon& b, float margin)
+{
+    int edge_a = 0, edge_b = 0;
+    const float sep_a = max_separation(a, b, edge_a);
+    if (sep_a > margin) return {};
+    const float sep_b = max_separation(b, a, edge_b);
+    if (sep_b > margin) return {};
+
+    const bool flip = sep_b > sep_a + FACE_TOLERANCE;
+    const WorldPolygon& ref = flip ? b : a;
+    const WorldPolygon& inc = flip ? a : b;
+    const int edge = flip ? edge_b : edge_a;
+    const vec2 n = ref.n[edge];
+
+    int inc_edge = 0;
+    float min_dot = FLT_MAX;
+    for (int i = 0; i < inc.count; ++i)
+    {
+        const float d = glm::dot(n, inc.n[i]);
+        if (d < min_dot)
+        {
+            min_dot = d;
+            inc_edge = i;
+        }
+    }
+
+    const std::uint32_t key = (flip ? 1u << 31 : 0u) | std::uint32_t(edge) << 16 | std::uint32_t(inc_edge) << 8;
+    const ClipVertex incident[2] = {{inc.v[inc_edge], key | 0u}, {inc.v[(inc_edge + 1) % inc.count], key | 1u}};
+
+    const vec2 v1 = ref.v[edge];
+    const vec2 v2 = ref.v[(edge + 1) % ref.count];
+    const vec2 t = glm::normalize(v2 - v1);
+
+    ClipVertex side[2], clipped[2];
+    if (clip(incident, side, -t, -glm::dot(t, v1), key | 2u) < 2) return {};
+    if (clip(side, clipped, t, glm::dot(t, v2), key | 3u) < 2) return {};
+
+    Manifold m;
+    m.normal = flip ? -n : n;
+    for (const ClipVertex& c : clipped)
+    {
+        const float separation = glm::dot(n, c.p - v1);
+        if (separation > margin) continue;
+
+        ManifoldPoint& mp = m.points[m.count++];
+        mp.point = c.p - n * (0.5f * separation);
+        mp.separation = separation;
+        mp.id = c.id;
+    }
+    return m;
+}
+
+// Normal points from the polygon to the circle
+static Manifold collide_polygon_circle(const WorldPolygon& a, vec2 c, float radius, float margin)
+{
+    int edge = 0;
+    float sep = -FLT_MAX;
+    for (int i = 0; i < a.count; ++i)
+    {
+        const float s = glm::dot(a.n[i], c - a.v[i]);
+        if (s > radius + margin) return {};
+        if (s > sep)
+        {
+            sep = s;
+            edge = i;
+        }
+    }
+
+    const int next = (edge + 1) % a.count;
+    vec2 normal = a.n[edge];
+    float distance = sep;
+    std::uint32_t id = std::uint32_t(edge);
+
+    // Outside the face: the nearest feature may be one of its vertices
+    if (sep > 0.f)
+    {
+        const vec2 v1 = a.v[edge];
+        const vec2 v2 = a.v[next];
+        const bool before = glm::dot(c - v1, v2 - v1) <= 0.f;
+        const bool after = glm::dot(c - v2, v1 - v2) <= 0.f;
+        if (before || after)
+        {
+            const vec2 v = before ? v1 : v2;
+            distance = glm::length(c - v);
+            if (distance > radius + margin) return {};
+            if (distance > 1e-6f) normal = (c - v) / distance;
+            id = 1u << 8 | std::uint32_t(before ? edge : next);
+        }
+    }
+
+    Manifold m;
+    m.normal = normal;
+    m.count = 1;
+    m.points[0].separation = distance - radius;
+    m.points[0].point = c - normal * (radius + 0.5f * m.points[0].separation);
+    m.points[0].id = id;
+    return m;
+}
+
+Manifold collide(const Shape& a, vec2 pa, Rotation ra, const Shape& b, vec2 pb, Rotation rb, float margin)
+{
+    const bool circle_a = a.type == ShapeType::Circle;
+    const bool circle_b = b.type == ShapeType::Circle;
+
+    if (circle_a && circle_b)
+    {
+        const vec2 d = pb - pa;
+        const float distance = glm::length(d);
+        const float separation = distance - a.radius - b.radius;
+        if (separation > margin) return {};
+
+        Manifold m;
+        m.normal = distance > 1e-6f ? d / distance : vec2(0.f, 1.f);
+        m.count = 1;
+        m.points[0].separation = separation;
+        m.points[0].point = pa + m.normal * (a.radius + 0.5f * separation);
+        return m;
+    }
+
+    if (circle_b) return collide_polygon_circle(to_world(a, pa, ra), pb, b.radius, margin);
+
+    if (circle_a)
+    {
+        Manifold m = collide_polygon_circle(to_world(b, pb, rb), pa, a.radius, margin);
+        m.normal = -m.normal;
+        return m;
+    }
+
+    return collide_polygons(to_world(a, pa, ra), to_world(b, pb, rb), margin);
+}
+
+// separation(), plus the axis it was measured along, from A towards B. The shapes are at least the returned gap
+// apart along that axis, which is what lets time_of_impact() advance by the closing speed along it alone.
+static float separation(const Shape& a, vec2 pa, Rotation ra, const Shape& b, vec2 pb, Rotation rb, vec2& axis)
+{
+    const bool circle_a = a.type == ShapeType::Circle;
+    const bool circle_b = b.type == ShapeType::Circle;
+
+    if (circle_a && circle_b)
+    {
+        const vec2 d = pb - pa;
+        const float distance = glm::length(d);
+        axis = distance > 1e-6f ? d / distance : vec2(0.f, 1.f);
+        return distance - a.radius - b.radius;
+    }
+
+    if (circle_b || circle_a)
+    {
+        const Manifold m = circle_b ? collide_polygon_circle(to_world(a, pa, ra), pb, b.radius, FLT_MAX)
+                                    : collide_polygon_circle(to_world(b, pb, rb), pa, a.radius, FLT_MAX);
+        axis = circle_b ? m.normal : -m.normal;
+        return m.points[0].separation;
+    }
+
+    int edge_a = 0, edge_b = 0;
+    const WorldPolygon wa = to_world(a, pa, ra);
+    const WorldPolygon wb = to_world(b, pb, rb);
+    const float sep_a = max_separation(wa, wb, edge_a);
+    const float sep_b = max_separation(wb, wa, edge_b);
+    axis = sep_a >= sep_b ? wa.n[edge_a] : -wb.n[edge_b];
+    return std::max(sep_a, sep_b);
+}
+
+float separation(const Shape& a, vec2 pa, Rotation ra, const Shape& b, vec2 pb, Rotation rb)
+{
+    vec2 axis;
+    return separation(a, pa, ra, b, pb, rb, axis);
+}
+
+// / CASTS // /
+
+CastHit ray_cast(const AABB& box, vec2 origin, vec2 translation)
+{
+    // Slabs; the last axis to be entered is the face hit
+    float lower = -FLT_MAX;
+    float upper = FLT_MAX;
+    vec2 normal{0.f};
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        if (translation[axis] == 0.f)
+        {
+            if (origin[axis] < box.min[axis] || origin[axis] > box.max[axis]) return {};
+            continue;
+        }
+
+        const float inv = 1.f / translation[axis];
+        float enter = (box.min[axis] - origin[axis]) * inv;
+        float exit = (box.max[axis] - origin[axis]) * inv;
+        float side = -1.f;
+        if (enter > exit)
+        {
+            std::swap(enter, exit);
+            side = 1.f;
+        }
+
+        if (enter > lower)
+        {
+            lower = enter;
+            normal = vec2(0.f);
+            normal[axis] = side;
+        }
+        upper = std::min(upper, exit);
+    }
+
+    if (lower > upper || lower < 0.f || lower > 1.f) return {};
+    return {true, lower, origin + lower * translation, normal};
+}
+
+CastHit ray_cast(const Shape& shape, vec2 position, Rotation r, vec2 origin, vec2 translation)
+{
+    if (shape.type == ShapeType::Circle)
+    {
+        const vec2 s = origin - position;
+        const float a = glm::dot(translation, translation);
+        const float b = glm::dot(s, translation);
+        const float c = glm::dot(s, s) - shape.radius * shape.radius;
+        const float discriminant = b * b - a * c;
+        if (c < 0.f || a == 0.f || discriminant < 0.f) return {};
+
+        const float t = (-b - std::sqrt(discriminant)) / a;
+        if (t < 0.f || t > 1.f) return {};
+
+        const vec2 point = origin + t * translation;
+        return {true, t, point, glm::normalize(point - position)};
+    }
+
+    // Clip the ray against every edge's half plane in body space
+    const vec2 o = unrotate(r, origin - position);
+    const vec2 d = unrotate(r, translation);
+    float lower = 0.f;
+    float upper = 1.f;
+    int index = -1;
+    for (int i = 0; i < shape.count; ++i)
+    {
+        const float numerator = glm::dot(shape.normals[i], shape.vertices[i] - o);
+        const float denominator = glm::dot(shape.normals[i], d);
+        if (denominator == 0.f)
+        {
+            if (numerator < 0.f) return {};
+        }
+        else if (denominator < 0.f && numerator < lower * denominator)
+        {
+            lower = numerator / denominator;
+            index = i;
+        }
+        else if (denominator > 0.f && numerator < upper * denominator)
+        {
+            upper = numerator / denominator;
+        }
+
+        if (upper < lower) return {};
+    }
+
+    if (index < 0) return {};
+    return {true, lower, origin + lower * translation, rotate(r, shape.normals[index])};
+}
+
+CastHit sweep_aabb(const AABB& moving, vec2 translation, const AABB& target)
+{
+    if (overlaps(moving, target))
+        return {true, 0.f, 0.5f * (glm::max(moving.min, target.min) + glm::min(moving.max, target.max)), vec2(0.f)};
+
+    // A point against the target grown by the moving box
+    const vec2 half = 0.5f * (moving.max - moving.min);
+    CastHit hit = ray_cast(AABB{target.min - half, target.max + half}, moving.min + half, translation);
+    if (hit.hit) hit.point -= hit.normal * half;
+    return hit;
+}
+
+CastHit time_of_impact(const Shape& a, const Sweep& sa, const Shape& b, const Sweep& sb, float target)
+{
+    // Per unit of fraction: B's motion relative to A, and the most turning can close any gap
+    const vec2 relative = (sb.p1 - sb.p0) - (sa.p1 - sa.p0);
+    const float turning = std::abs(sa.a1 - sa.a0) * max_extent(a) + std::abs(sb.a1 - sb.a0) * max_extent(b);
+
+    float t = 0.f;
+    for (int iteration = 0; iteration < TOI_ITERATIONS; ++iteration)
+    {
+        const vec2 pa = glm::mix(sa.p0, sa.p1, t);
+        const vec2 pb = glm::mix(sb.p0, sb.p1, t);
+        const Rotation ra = rotation(glm::mix(sa.a0, sa.a1, t));
+        const Rotation rb = rotation(glm::mix(sb.a0, sb.a1, t));
+
+        vec2 axis;
+        const float gap = separation(a, pa, ra, b, pb, rb, axis);
+        if (gap < target + TOI_TOLERANCE)
+        {
+            CastHit hit;
+            hit.hit = true;
+            hit.fraction = t;
+
+            const Manifold m = collide(a, pa, ra, b, pb, rb, FLT_MAX);
+            if (m.count > 0)
+            {
+                hit.normal = -m.normal;
+                hit.point = m.count == 2 ? 0.5f * (m.points[0].point + m.points[1].point) : m.points[0].point;
+            }
+            else
+            {
+                const vec2 d = pa - pb;
+                hit.normal = glm::dot(d, d) > 0.f ? glm::normalize(d) : vec2(0.f, -1.f);
+                hit.point = 0.5f * (pa + pb);
+            }
+            return hit;
+        }
+
+        // The gap along the axis can close no faster than this, so advancing by it never overshoots
+        const float closing = std::max(0.f, -glm::dot(axis, relative)) + turning;
+        if (closing <= 0.f) return {};
+        t += (gap - target) / closing;
+        if (t >= 1.f) return {};
+    }
+
+    // Out of iterations, typically sliding past with a small gap: not a hit, though nothing was touched up to t
+    CastHit miss;
+    miss.fraction = t;
+    return miss;
+}
+
+// / END CASTS / //
+
+}  // namespace kine::physics
@@ -0,0 +1,131 @@
+#include "kine/render/gl_state.hpp"
+
+namespace kine::gl_state
+{
+
+// True when the cached value differs; updates it and counts the call either way
+template <typename T>
+static bool changed(GLState* s, T& cached, T value)
+{
+    if (cached == value)
+    {
+        ++s->skipped;
+        return false;
+    }
+
+    cached = value;
+    ++s->issued;
+    return true;
+}
+
+void reset(GLState* s)
+{
+    s->program = GLState::UNKNOWN;
+    s->vao = GLState::UNKNOWN;
+    s->framebuffer = GLState::UNKNOWN;
+    s->blend = -1;
+    s->depth_test = -1;
+    s->blend_src = 0;
+    s->blend_dst = 0;
+    invalidate(s);
+}
+
+void invalidate(GLState* s)
+{
+    s->array_buffer = GLState::UNKNOWN;
+    s->active_unit = 0;
+    s->textures.fill(GLState::UNKNOWN);
+    s->viewport = {-1, -1, -1, -1};
+}
+
+void use_program(GLState* s, GLuint program)
+{
+    if (changed(s, s->program, program)) glUseProgram(program);
+}
+
+void bind_vertex_array(GLState* s, GLuint vao)
+{
+    if (changed(s, s->vao, vao)) glBindVertexArray(vao);
+}
+
+void bind_array_buffer(GLState* s, GLuint buffer)
+{
+    if (changed(s, s->array_buffer, buffer)) glBindBuffer(GL_ARRAY_BUFFER, buffer);
+}
+
+void bind_framebuffer(GLState* s, GLuint fbo)
+{
+    if (changed(s, s->framebuffer, fbo)) glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+}
+
+void bind_texture(GLState* s, uint32_t unit, GLuint texture)
+{
+    if (unit >= GLState::TEXTURE_UNITS)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        s->active_unit = GL_TEXTURE0 + unit;
+        s->issued += 2;
+        return;
+    }
+
+    if (s->textures[unit] == texture)
+    {
+        ++s->skipped;
+        return;
+    }
+
+    if (changed(s, s->active_unit, GLenum(GL_TEXTURE0 + unit))) glActiveTexture(GL_TEXTURE0 + unit);
+
+    s->textures[unit] = texture;
+    ++s->issued;
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void set_blend(GLState* s, bool enabled)
+{
+    if (!changed(s, s->blend, int8_t(enabled))) return;
+
+    if (enabled)
+        glEnable(GL_BLEND);
+    else
+        glDisable(GL_BLEND);
+}
+
+void set_depth_test(GLState* s, bool enabled)
+{
+    if (!changed(s, s->depth_test, int8_t(enabled))) return;
+
+    if (enabled)
+        glEnable(GL_DEPTH_TEST);
+    else
+        glDisable(GL_DEPTH_TEST);
+}
+
+void blend_func(GLState* s, GLenum src, GLenum dst)
+{
+    if (s->blend_src == src && s->blend_dst == dst)
+    {
+        ++s->skipped;
+        return;
+    }
+
+    s->blend_src = src;
+    s->blend_dst = dst;
+    ++s->issued;
+    glBlendFunc(src, dst);
+}
+
+void viewport(GLState* s, GLint x, GLint y, GLint width, GLint height)
+{
+    if (!changed(s, s->viewport, std::array<GLint, 4>{x, y, width, height})) return;
+    glViewport(x, y, width, height);
+}
+
+void forget_texture(GLState* s, GLuint texture)
+{
+    for (GLuint& bound : s->textures)
+        if (bound == texture) bound = 0;
+}
+
+}  // namespace kine::gl_state
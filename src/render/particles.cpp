@@ -0,0 +1,316 @@
+#include "kine/render/particles.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define KINE_PARTICLES_SSE 1
+#endif
+
+#include "kine/log.hpp"
+#include "kine/render/shaders.hpp"
+#include "kine/resources/residency.hpp"
+
+namespace kine::particles
+{
+
+// Arrays are padded to whole SIMD lanes so the kernel needs no tail loop
+static constexpr std::uint32_t LANES = 4;
+
+static std::uint32_t padded(std::uint32_t n) { return (n + LANES - 1) & ~(LANES - 1); }
+
+// xorshift64*, uniform in [0, 1)
+static float random01(ParticleSystem* ps)
+{
+    ps->rng ^= ps->rng >> 12;
+    ps->rng ^= ps->rng << 25;
+    ps->rng ^= ps->rng >> 27;
+    return float((ps->rng * 2685821657736338717ull) >> 40) * (1.f / 16777216.f);
+}
+
+static float random_range(ParticleSystem* ps, float lo, float hi) { return lo + (hi - lo) * random01(ps); }
+
+void init(ParticleSystem* ps, GLState* gl)
+{
+    ps->shader = resource::build_shader(renderer2d::particle_vert, renderer2d::particle_frag);
+    ps->loc_projection = resource::uniform_location(ps->shader, "uProjection");
+    ps->loc_size = resource::uniform_location(ps->shader, "uSize");
+    ps->loc_color_start = resource::uniform_location(ps->shader, "uColorStart");
+    ps->loc_color_end = resource::uniform_location(ps->shader, "uColorEnd");
+    ps->loc_textured = resource::uniform_location(ps->shader, "uTextured");
+
+    gl_state::use_program(gl, ps->shader.program);
+    resource::set_uniform(ps->shader, resource::uniform_location(ps->shader, "uTexture"), 0);
+
+    glGenVertexArrays(1, &ps->vao);
+    glGenBuffers(1, &ps->vbo);
+
+    gl_state::bind_vertex_array(gl, ps->vao);
+    gl_state::bind_array_buffer(gl, ps->vbo);
+    for (GLuint attrib = 0; attrib < 3; ++attrib)
+    {
+        glEnableVertexAttribArray(attrib);
+        glVertexAttribDivisor(attrib, 1);
+    }
+    gl_state::bind_vertex_array(gl, 0);
+}
+
+void shutdown(ParticleSystem* ps)
+{
+    if (ps->vbo) glDeleteBuffers(1, &ps->vbo);
+    if (ps->vao) glDeleteVertexArrays(1, &ps->vao);
+    glDeleteProgram(ps->shader.program);
+
+    ps->vbo = 0;
+    ps->vao = 0;
+    ps->shader = {};
+    ps->emitters.clear();
+    ps->free_slots.clear();
+    ps->live_particles = 0;
+}
+
+EmitterHandle create_emitter(ParticleSystem* ps, const EmitterConfig& config)
+{
+    std::uint32_t index;
+    if (!ps->free_slots.empty())
+    {
+        index = ps->free_slots.back();
+        ps->free_slots.pop_back();
+    }
+    else
+    {
+        index = static_cast<std::uint32_t>(ps->emitters.size());
+        ps->emitters.emplace_back();
+    }
+
+    ParticleEmitter& e = ps->emitters[index];
+    e.config = config;
+    e.count = 0;
+    e.spawn_carry = 0.f;
+    e.emitting = true;
+    e.releasing = false;
+    e.live = true;
+
+    // resize() keeps the capacity of a recycled slot
+    const std::uint32_t n = padded(config.max_particles);
+    for (std::vector<float>* a : {&e.x, &e.y, &e.vx, &e.vy, &e.t, &e.rate}) a->resize(n);
+
+    return {index, e.generation};
+}
+
+ParticleEmitter* get(ParticleSystem* ps, EmitterHandle handle)
+{
+    if (handle.index >= ps->emitters.size()) return nullptr;
+
+    ParticleEmitter& e = ps->emitters[handle.index];
+    return e.live && e.generation == handle.generation ? &e : nullptr;
+}
+
+static void free_slot(ParticleSystem* ps, std::uint32_t index)
+{
+    ParticleEmitter& e = ps->emitters[index];
+    e.live = false;
+    e.count = 0;
+    if (++e.generation == 0) e.generation = 1;
+    ps->free_slots.push_back(index);
+}
+
+void destroy_emitter(ParticleSystem* ps, EmitterHandle handle)
+{
+    ParticleEmitter* e = get(ps, handle);
+    if (!e) return;
+
+    e->emitting = false;
+    e->releasing = true;
+    if (e->count == 0) free_slot(ps, handle.index);
+}
+
+void set_position(ParticleSystem* ps, EmitterHandle handle, vec2 position)
+{
+    if (ParticleEmitter* e = get(ps, handle)) e->config.position = position;
+}
+
+void set_emitting(ParticleSystem* ps, EmitterHandle handle, bool emitting)
+{
+    if (ParticleEmitter* e = get(ps, handle)) e->emitting = emitting;
+}
+
+static void spawn(ParticleSystem* ps, ParticleEmitter& e, std::uint32_t n)
+{
+    const EmitterConfig& c = e.config;
+    n = std::min(n, c.max_particles - e.count);
+
+    for (std::uint32_t k = 0; k < n; ++k)
+    {
+        const std::uint32_t i = e.count++;
+
+        const float angle = c.direction + random_range(ps, -c.spread, c.spread);
+        const float speed = random_range(ps, c.speed_min, c.speed_max);
+        const float offset_angle = random01(ps) * 6.2831853f;
+        const float offset = c.spawn_radius * std::sqrt(random01(ps));
+
+        e.x[i] = c.position.x + std::cos(offset_angle) * offset;
+        e.y[i] = c.position.y + std::sin(offset_angle) * offset;
+        e.vx[i] = std::cos(angle) * speed;
+        e.vy[i] = std::sin(angle) * speed;
+        e.t[i] = 0.f;
+        e.rate[i] = 1.f / std::max(random_range(ps, c.lifetime_min, c.lifetime_max), 1e-3f);
+    }
+}
+
+void burst(ParticleSystem* ps, EmitterHandle handle, std::uint32_t count)
+{
+    if (ParticleEmitter* e = get(ps, handle)) spawn(ps, *e, count);
+}
+
+// Integrate every lane up to count rounded up; the padding lanes are harmless garbage
+static void simulate(ParticleEmitter& e, float dt)
+{
+    const EmitterConfig& c = e.config;
+    const float damp = std::max(0.f, 1.f - c.drag * dt);
+    const float gx = c.gravity.x * dt;
+    const float gy = c.gravity.y * dt;
+
+    float* x = e.x.data();
+    float* y = e.y.data();
+    float* vx = e.vx.data();
+    float* vy = e.vy.data();
+    float* t = e.t.data();
+    const float* rate = e.rate.data();
+    const std::uint32_t n = padded(e.count);
+
+#ifdef KINE_PARTICLES_SSE
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vdamp = _mm_set1_ps(damp);
+    const __m128 vgx = _mm_set1_ps(gx);
+    const __m128 vgy = _mm_set1_ps(gy);
+
+    for (std::uint32_t i = 0; i < n; i += LANES)
+    {
+        const __m128 nvx = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(vx + i), vdamp), vgx);
+        const __m128 nvy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(vy + i), vdamp), vgy);
+        _mm_storeu_ps(vx + i, nvx);
+        _mm_storeu_ps(vy + i, nvy);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(nvx, vdt)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(nvy, vdt)));
+        _mm_storeu_ps(t + i, _mm_add_ps(_mm_loadu_ps(t + i), _mm_mul_ps(_mm_loadu_ps(rate + i), vdt)));
+    }
+#else
+    for (std::uint32_t i = 0; i < n; ++i)
+    {
+        vx[i] = vx[i] * damp + gx;
+        vy[i] = vy[i] * damp + gy;
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        t[i] += rate[i] * dt;
+    }
+#endif
+}
+
+// Swap dead particles with the last live one; groups of four with no deaths are skipped whole
+static void retire(ParticleEmitter& e)
+{
+    std::uint32_t i = 0;
+    while (i < e.count)
+    {
+#ifdef KINE_PARTICLES_SSE
+        if (i + LANES <= e.count && _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(&e.t[i]), _mm_set1_ps(1.f))) == 0)
+        {
+            i += LANES;
+            continue;
+        }
+#endif
+        if (e.t[i] < 1.f)
+        {
+            ++i;
+            continue;
+        }
+
+        const std::uint32_t last = --e.count;
+        e.x[i] = e.x[last];
+        e.y[i] = e.y[last];
+        e.vx[i] = e.vx[last];
+        e.vy[i] = e.vy[last];
+        e.t[i] = e.t[last];
+        e.rate[i] = e.rate[last];
+    }
+}
+
+void update(ParticleSystem* ps, float dt)
+{
+    const auto start = std::chrono::steady_clock::now();
+    ps->live_particles = 0;
+
+    for (std::uint32_t index = 0; index < ps->emitters.size(); ++index)
+    {
+        ParticleEmitter& e = ps->emitters[index];
+        if (!e.live) continue;
+
+        simulate(e, dt);
+        retire(e);
+
+        if (e.emitting && e.config.rate > 0.f)
+        {
+            e.spawn_carry += e.config.rate * dt;
+            const auto n = static_cast<std::uint32_t>(e.spawn_carry);
+            e.spawn_carry -= float(n);
+            spawn(ps, e, n);
+        }
+
+        if (e.releasing && e.count == 0)
+        {
+            free_slot(ps, index);
+            continue;
+        }
+
+        ps->live_particles += e.count;
+    }
+
+    ps->update_ns = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+void draw(ParticleSystem* ps, GLState* gl, const mat4& projection)
+{
+    if (ps->live_particles == 0) return;
+
+    resource::Shader& s = ps->shader;
+    gl_state::use_program(gl, s.program);
+    resource::set_uniform(s, ps->loc_projection, projection);
+
+    gl_state::bind_vertex_array(gl, ps->vao);
+    gl_state::bind_array_buffer(gl, ps->vbo);
+
+    for (const ParticleEmitter& e : ps->emitters)
+    {
+        if (!e.live || e.count == 0) continue;
+        const EmitterConfig& c = e.config;
+
+        // Orphan, then upload the three arrays back to back
+        const GLsizeiptr bytes = GLsizeiptr(e.count) * GLsizeiptr(sizeof(float));
+        glBufferData(GL_ARRAY_BUFFER, bytes * 3, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, e.x.data());
+        glBufferSubData(GL_ARRAY_BUFFER, bytes, bytes, e.y.data());
+        glBufferSubData(GL_ARRAY_BUFFER, bytes * 2, bytes, e.t.data());
+
+        glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, 0, (void*) 0);
+        glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 0, (void*) bytes);
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 0, (void*) (bytes * 2));
+
+        resource::set_uniform(s, ps->loc_size, vec2(c.size_start, c.size_end));
+        resource::set_uniform(s, ps->loc_color_start, c.color_start);
+        resource::set_uniform(s, ps->loc_color_end, c.color_end);
+
+        const bool textured = c.texture.valid();
+        resource::set_uniform(s, ps->loc_textured, textured ? 1 : 0);
+        if (textured) gl_state::bind_texture(gl, 0, resource::residency::use(c.texture).id);
+
+        if (c.additive) gl_state::blend_func(gl, GL_SRC_ALPHA, GL_ONE);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(e.count));
+        if (c.additive) gl_state::blend_func(gl, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+}
+
+}  // namespace kine::particles
@@ -0,0 +1,158 @@
+#include "kine/render/post_fx.hpp"
+
+#include <algorithm>
+
+#include "kine/render/shaders.hpp"
+
+namespace kine::post_fx
+{
+
+using resource::set_uniform;
+using resource::uniform_location;
+
+static void build(resource::Shader& shader, const std::string& frag, GLState* gl)
+{
+    shader = resource::build_shader(renderer2d::post_vert, frag);
+
+    gl_state::use_program(gl, shader.program);
+    set_uniform(shader, uniform_location(shader, "uTexture"), 0);
+    set_uniform(shader, uniform_location(shader, "uBloom"), 1);
+}
+
+static void draw_quad(GLState* gl, GLuint quad)
+{
+    gl_state::bind_vertex_array(gl, quad);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+void init(PostFx* fx, GLState* gl)
+{
+    build(fx->bright_shader, renderer2d::bright_frag, gl);
+    build(fx->blur_shader, renderer2d::blur_frag, gl);
+    build(fx->bloom_shader, renderer2d::bloom_frag, gl);
+    build(fx->grade_shader, renderer2d::grade_frag, gl);
+    build(fx->crt_shader, renderer2d::crt_frag, gl);
+
+    fx->loc_threshold = uniform_location(fx->bright_shader, "uThreshold");
+    fx->loc_direction = uniform_location(fx->blur_shader, "uDirection");
+    fx->loc_intensity = uniform_location(fx->bloom_shader, "uIntensity");
+    fx->loc_exposure = uniform_location(fx->grade_shader, "uExposure");
+    fx->loc_contrast = uniform_location(fx->grade_shader, "uContrast");
+    fx->loc_saturation = uniform_location(fx->grade_shader, "uSaturation");
+    fx->loc_tint = uniform_location(fx->grade_shader, "uTint");
+    fx->loc_resolution = uniform_location(fx->crt_shader, "uResolution");
+    fx->loc_curvature = uniform_location(fx->crt_shader, "uCurvature");
+    fx->loc_scanlines = uniform_location(fx->crt_shader, "uScanlines");
+    fx->loc_vignette = uniform_location(fx->crt_shader, "uVignette");
+}
+
+void shutdown(PostFx* fx)
+{
+    for (resource::Shader* s :
+         {&fx->bright_shader, &fx->blur_shader, &fx->bloom_shader, &fx->grade_shader, &fx->crt_shader})
+    {
+        glDeleteProgram(s->program);
+        *s = {};
+    }
+}
+
+bool any(const PostFx* fx) { return fx->bloom || fx->color_grading || fx->crt; }
+
+static TargetId add_bloom(PostFx* fx, RenderGraph* g, GLState* gl, GLuint quad, TargetId input)
+{
+    const TargetDesc src = render_graph::desc(g, input);
+
+    // Blur at half resolution; bilinear taps need linear filtering
+    TargetDesc half{std::max(1, src.width / 2), std::max(1, src.height / 2), src.format, GL_LINEAR};
+    const vec2 texel(1.f / float(half.width), 1.f / float(half.height));
+
+    TargetId bright = render_graph::create_target(g, half);
+    render_graph::add_pass(g, "bloom_bright", {input}, bright,
+                           [fx, gl, quad](RenderGraph* graph, const RenderPass& pass)
+                           {
+                               resource::Shader& s = fx->bright_shader;
+                               gl_state::use_program(gl, s.program);
+                               set_uniform(s, fx->loc_threshold, fx->bloom_threshold);
+                               gl_state::bind_texture(gl, 0, render_graph::texture(graph, pass.reads[0]));
+                               draw_quad(gl, quad);
+                           });
+
+    TargetId blurred = bright;
+    for (vec2 direction : {vec2(texel.x, 0.f), vec2(0.f, texel.y)})
+    {
+        TargetId out = render_graph::create_target(g, half);
+        render_graph::add_pass(g, "bloom_blur", {blurred}, out,
+                               [fx, gl, quad, direction](RenderGraph* graph, const RenderPass& pass)
+                               {
+                                   resource::Shader& s = fx->blur_shader;
+                                   gl_state::use_program(gl, s.program);
+                                   set_uniform(s, fx->loc_direction, direction);
+                                   gl_state::bind_texture(gl, 0, render_graph::texture(graph, pass.reads[0]));
+                                   draw_quad(gl, quad);
+                               });
+        blurred = out;
+    }
+
+    TargetId out = render_graph::create_target(g, src);
+    render_graph::add_pass(g, "bloom_composite", {input, blurred}, out,
+                           [fx, gl, quad](RenderGraph* graph, const RenderPass& pass)
+                           {
+                               resource::Shader& s = fx->bloom_shader;
+                               gl_state::use_program(gl, s.program);
+                               set_uniform(s, fx->loc_intensity, fx->bloom_intensity);
+                               gl_state::bind_texture(gl, 0, render_graph::texture(graph, pass.reads[0]));
+                               gl_state::bind_texture(gl, 1, render_graph::texture(graph, pass.reads[1]));
+                               draw_quad(gl, quad);
+                           });
+    return out;
+}
+
+static TargetId add_color_grading(PostFx* fx, RenderGraph* g, GLState* gl, GLuint quad, TargetId input)
+{
+    TargetId out = render_graph::create_target(g, render_graph::desc(g, input));
+    render_graph::add_pass(g, "color_grading", {input}, out,
+                           [fx, gl, quad](RenderGraph* graph, const RenderPass& pass)
+                           {
+                               resource::Shader& s = fx->grade_shader;
+                               gl_state::use_program(gl, s.program);
+                               set_uniform(s, fx->loc_exposure, fx->exposure);
+                               set_uniform(s, fx->loc_contrast, fx->contrast);
+                               set_uniform(s, fx->loc_saturation, fx->saturation);
+                               set_uniform(s, fx->loc_tint, fx->tint);
+                               gl_state::bind_texture(gl, 0, render_graph::texture(graph, pass.reads[0]));
+                               draw_quad(gl, quad);
+                           });
+    return out;
+}
+
+static TargetId add_crt(PostFx* fx, RenderGraph* g, GLState* gl, GLuint quad, TargetId input)
+{
+    const TargetDesc src = render_graph::desc(g, input);
+    const vec2 resolution(src.width, src.height);
+
+    TargetId out = render_graph::create_target(g, src);
+    render_graph::add_pass(g, "crt", {input}, out,
+                           [fx, gl, quad, resolution](RenderGraph* graph, const RenderPass& pass)
+                           {
+                               resource::Shader& s = fx->crt_shader;
+                               gl_state::use_program(gl, s.program);
+                               set_uniform(s, fx->loc_resolution, resolution);
+                               set_uniform(s, fx->loc_curvature, fx->crt_curvature);
+                               set_uniform(s, fx->loc_scanlines, fx->crt_scanlines);
+                               set_uniform(s, fx->loc_vignette, fx->crt_vignette);
+                               gl_state::bind_texture(gl, 0, render_graph::texture(graph, pass.reads[0]));
+                               draw_quad(gl, quad);
+                           });
+    return out;
+}
+
+TargetId add_passes(PostFx* fx, RenderGraph* g, GLState* gl, GLuint quad, TargetId input)
+{
+    TargetId result = input;
+    if (fx->bloom) result = add_bloom(fx, g, gl, quad, result);
+    if (fx->color_grading) result = add_color_grading(fx, g, gl, quad, result);
+    if (fx->crt) result = add_crt(fx, g, gl, quad, result);
+    return result;
+}
+
+}  // namespace kine::post_fx
@@ -1,6 +1,7 @@
 #include "kine/render/render_batcher.hpp"
 
 #include <algorithm>
+#include "kine/resources/residency.hpp"
 #include "kine/resources/texture_manager.hpp"
 
 namespace kine::render_batcher
@@ -38,12 +39,12 @@ void build(RenderBatcher* rb, const std::vector<RenderCommand>& commands)
                          Texture2D* tb = nullptr;
 
                          if (a->type == RenderType::Sprite)
-                             ta = &resource::get_texture(a->texture_name);
+                             ta = &resource::peek_texture(a->texture);
                          else if (a->type == RenderType::Text && a->font)
                              ta = a->font->texture;
 
                          if (b->type == RenderType::Sprite)
-                             tb = &resource::get_texture(b->texture_name);
+                             tb = &resource::peek_texture(b->texture);
                          else if (b->type == RenderType::Text && b->font)
                              tb = b->font->texture;
 
@@ -59,7 +60,7 @@ void build(RenderBatcher* rb, const std::vector<RenderCommand>& commands)
         switch (cmd->type)
         {
         case RenderType::Sprite:
-            texture = &resource::get_texture(cmd->texture_name);
+            texture = &resource::residency::use(cmd->texture);
             break;
 
         case RenderType::Text:
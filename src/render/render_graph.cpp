@@ -0,0 +1,224 @@
+#include "kine/render/render_graph.hpp"
+
+#include <algorithm>
+
+#include "kine/log.hpp"
+
+namespace kine::render_graph
+{
+
+static constexpr uint32_t UNASSIGNED = ~0u;
+
+static std::size_t bytes_per_pixel(GLenum format)
+{
+    switch (format)
+    {
+    case GL_RGBA16F:
+        return 8;
+    case GL_RGBA32F:
+        return 16;
+    case GL_R8:
+        return 1;
+    default:
+        return 4;
+    }
+}
+
+static RenderTarget create_render_target(GLState* gl, const TargetDesc& desc)
+{
+    RenderTarget rt;
+    rt.desc = desc;
+
+    glGenTextures(1, &rt.color);
+    gl_state::bind_texture(gl, 0, rt.color);
+    glTexImage2D(GL_TEXTURE_2D, 0, desc.format, desc.width, desc.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, desc.filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, desc.filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &rt.fbo);
+    gl_state::bind_framebuffer(gl, rt.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, rt.color, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        LOG_WARN("RenderGraph: {}x{} target incomplete", desc.width, desc.height);
+
+    return rt;
+}
+
+static void destroy_render_target(GLState* gl, RenderTarget& rt)
+{
+    // Deleting the bound framebuffer reverts the binding to 0
+    if (gl->framebuffer == rt.fbo) gl->framebuffer = 0;
+    gl_state::forget_texture(gl, rt.color);
+
+    glDeleteFramebuffers(1, &rt.fbo);
+    glDeleteTextures(1, &rt.color);
+    rt = {};
+}
+
+void begin(RenderGraph* g, int backbuffer_width, int backbuffer_height)
+{
+    g->targets.clear();
+    g->passes.clear();
+    g->physical.clear();
+    g->backbuffer_width = backbuffer_width;
+    g->backbuffer_height = backbuffer_height;
+}
+
+TargetId create_target(RenderGraph* g, const TargetDesc& desc)
+{
+    g->targets.push_back(desc);
+    return static_cast<TargetId>(g->targets.size() - 1);
+}
+
+void add_pass(RenderGraph* g, std::string name, std::vector<TargetId> reads, TargetId write, PassFunc execute)
+{
+    if (std::find(reads.begin(), reads.end(), write) != reads.end())
+        LOG_THROW("RenderGraph: pass '{}' reads the target it writes", name);
+
+    g->passes.push_back({std::move(name), std::move(reads), write, std::move(execute)});
+}
+
+void compile(RenderGraph* g, GLState* gl)
+{
+    const std::size_t target_count = g->targets.size();
+    const std::size_t pass_count = g->passes.size();
+
+    // Cull backwards from the backbuffer: a pass survives if something downstream reads what it writes
+    std::vector<bool> needed(target_count, false);
+    for (std::size_t i = pass_count; i-- > 0;)
+    {
+        RenderPass& pass = g->passes[i];
+        pass.culled = pass.write != BACKBUFFER && !needed[pass.write];
+        if (pass.culled) continue;
+
+        for (TargetId t : pass.reads) needed[t] = true;
+    }
+
+    // Lifetime of each target: first writing pass to last reading pass
+    std::vector<std::size_t> first(target_count, pass_count);
+    std::vector<std::size_t> last(target_count, 0);
+    for (std::size_t i = 0; i < pass_count; ++i)
+    {
+        const RenderPass& pass = g->passes[i];
+        if (pass.culled) continue;
+
+        if (pass.write != BACKBUFFER)
+        {
+            first[pass.write] = std::min(first[pass.write], i);
+            last[pass.write] = std::max(last[pass.write], i);
+        }
+        for (TargetId t : pass.reads) last[t] = std::max(last[t], i);
+    }
+
+    // Alias: a pooled target is free again once the last reader of its current occupant ran
+    g->physical.assign(target_count, UNASSIGNED);
+    std::vector<bool> busy(g->pool.size(), false);
+    std::vector<bool> used(g->pool.size(), false);
+    std::size_t live = 0;
+    g->peak_live = 0;
+
+    for (std::size_t i = 0; i < pass_count; ++i)
+    {
+        const RenderPass& pass = g->passes[i];
+        if (pass.culled) continue;
+
+        if (pass.write != BACKBUFFER && first[pass.write] == i)
+        {
+            const TargetDesc& want = g->targets[pass.write];
+
+            uint32_t slot = UNASSIGNED;
+            for (uint32_t p = 0; p < g->pool.size(); ++p)
+            {
+                if (busy[p] || !(g->pool[p].desc == want)) continue;
+                slot = p;
+                break;
+            }
+
+            if (slot == UNASSIGNED)
+            {
+                g->pool.push_back(create_render_target(gl, want));
+                busy.push_back(false);
+                used.push_back(false);
+                slot = static_cast<uint32_t>(g->pool.size() - 1);
+            }
+
+            g->physical[pass.write] = slot;
+            busy[slot] = true;
+            used[slot] = true;
+            g->peak_live = std::max(g->peak_live, ++live);
+        }
+
+        for (TargetId t = 0; t < target_count; ++t)
+        {
+            if (g->physical[t] == UNASSIGNED || last[t] != i || !busy[g->physical[t]]) continue;
+            busy[g->physical[t]] = false;
+            --live;
+        }
+    }
+
+    // Drop pool entries this frame did not need and compact
+    std::vector<uint32_t> remap(g->pool.size(), UNASSIGNED);
+    std::size_t kept = 0;
+    g->pool_bytes = 0;
+    for (std::size_t p = 0; p < g->pool.size(); ++p)
+    {
+        if (!used[p])
+        {
+            destroy_render_target(gl, g->pool[p]);
+            continue;
+        }
+
+        const TargetDesc& d = g->pool[p].desc;
+        g->pool_bytes += std::size_t(d.width) * std::size_t(d.height) * bytes_per_pixel(d.format);
+
+        remap[p] = static_cast<uint32_t>(kept);
+        g->pool[kept++] = g->pool[p];
+    }
+    g->pool.resize(kept);
+
+    for (uint32_t& slot : g->physical)
+        if (slot != UNASSIGNED) slot = remap[slot];
+}
+
+void execute(RenderGraph* g, GLState* gl)
+{
+    for (const RenderPass& pass : g->passes)
+    {
+        if (pass.culled) continue;
+
+        if (pass.write == BACKBUFFER)
+        {
+            gl_state::bind_framebuffer(gl, 0);
+            gl_state::viewport(gl, 0, 0, g->backbuffer_width, g->backbuffer_height);
+        }
+        else
+        {
+            const RenderTarget& rt = g->pool[g->physical[pass.write]];
+            gl_state::bind_framebuffer(gl, rt.fbo);
+            gl_state::viewport(gl, 0, 0, rt.desc.width, rt.desc.height);
+        }
+
+        pass.execute(g, pass);
+    }
+}
+
+GLuint texture(const RenderGraph* g, TargetId target)
+{
+    const uint32_t slot = g->physical[target];
+    return slot == UNASSIGNED ? 0 : g->pool[slot].color;
+}
+
+TargetDesc desc(const RenderGraph* g, TargetId target) { return g->targets[target]; }
+
+void release(RenderGraph* g, GLState* gl)
+{
+    for (RenderTarget& rt : g->pool) destroy_render_target(gl, rt);
+    g->pool.clear();
+    g->physical.clear();
+    g->pool_bytes = 0;
+}
+
+}  // namespace kine::render_graph
@@ -1,5 +1,6 @@
 #include "kine/render/render_list.hpp"
 #include "kine/log.hpp"
+#include "kine/resources/texture_manager.hpp"
 
 namespace kine::render
 {
@@ -26,11 +27,16 @@ bool is_initialized()
     return true;
 }
 
-void draw_sprite(const std::string& texture, vec2 pos, float rotation, vec2 pivot, float scale, int32_t layer)
+void draw_sprite(const std::string& texture_name, vec2 pos, float rotation, vec2 pivot, float scale, int32_t layer)
+{
+    draw_sprite(resource::find_texture(texture_name), pos, rotation, pivot, scale, layer);
+}
+
+void draw_sprite(TextureHandle texture, vec2 pos, float rotation, vec2 pivot, float scale, int32_t layer)
 {
     if (!is_initialized()) return;
     RenderCommand cmd = base_cmd(RenderType::Sprite, pos, scale, layer);
-    cmd.texture_name = texture;
+    cmd.texture = texture;
     cmd.rotation = rotation;
     cmd.pivotX = pivot.x;
     cmd.pivotY = pivot.y;
@@ -24,24 +24,33 @@ void create(Renderer2D* r)
 
 void init(Renderer2D* r)
 {
-    r->shader = resource::load_shader_str(screen_vert, screen_frag);
+    r->shader = resource::build_shader(screen_vert, screen_frag);
+    r->loc_projection = resource::uniform_location(r->shader, "uProjection");
+    r->loc_aspect = resource::uniform_location(r->shader, "uAspect");
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state::reset(&r->gl);
+    gl_state::set_blend(&r->gl, true);
+    gl_state::blend_func(&r->gl, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state::set_depth_test(&r->gl, false);
 
     create_gl_objects(r);
 
-    if (r->virtual_enabled)
-    {
-        r->blit_shader = resource::load_shader_str(blit_vert, blit_frag);
+    // Cheap enough to always have around, so virtual resolution and effects can be enabled later
+    r->blit_shader = resource::build_shader(blit_vert, blit_frag);
+    r->loc_final_scale = resource::uniform_location(r->blit_shader, "uFinalScale");
+    r->loc_final_offset = resource::uniform_location(r->blit_shader, "uFinalOffset");
+    r->loc_window_size = resource::uniform_location(r->blit_shader, "uWindowSize");
+    r->loc_virtual_size = resource::uniform_location(r->blit_shader, "uVirtualSize");
 
-        create_blit_objects(r);
-        glUseProgram(r->blit_shader);
-        glUniform1i(glGetUniformLocation(r->blit_shader, "uTexture"), 0);
-    }
+    create_blit_objects(r);
+    gl_state::use_program(&r->gl, r->blit_shader.program);
+    resource::set_uniform(r->blit_shader, resource::uniform_location(r->blit_shader, "uTexture"), 0);
 
-    glUseProgram(r->shader);
-    glUniform1i(glGetUniformLocation(r->shader, "uTexture"), 0);
+    post_fx::init(&r->post, &r->gl);
+    particles::init(&r->particles, &r->gl);
+
+    gl_state::use_program(&r->gl, r->shader.program);
+    resource::set_uniform(r->shader, resource::uniform_location(r->shader, "uTexture"), 0);
 }
 
 void shutdown(Renderer2D* r)
@@ -50,14 +59,16 @@ void shutdown(Renderer2D* r)
 
     destroy_gl_objects(r);
     destroy_blit_objects(r);
-
-    if (r->virtual_enabled)
-    {
-        glDeleteFramebuffers(1, &r->virtual_fbo);
-        glDeleteTextures(1, &r->virtual_color);
-        glDeleteRenderbuffers(1, &r->virtual_rbo);
-        r->virtual_enabled = false;
-    }
+    render_graph::release(&r->graph, &r->gl);
+    post_fx::shutdown(&r->post);
+    particles::shutdown(&r->particles);
+
+    glDeleteProgram(r->shader.program);
+    glDeleteProgram(r->blit_shader.program);
+    r->shader = {};
+    r->blit_shader = {};
+    gl_state::reset(&r->gl);
+    r->virtual_enabled = false;
 
     // TODO: Move to window.hpp
     if (r->window)
@@ -68,15 +79,15 @@ void shutdown(Renderer2D* r)
     glfwTerminate();
 }
 
-void begin_frame(Renderer2D*) {}
+void begin_frame(Renderer2D* r) { gl_state::invalidate(&r->gl); }
 void render(Renderer2D* r)
 {
     begin_frame(r);
 
     render_batcher::build(&r->batcher, render::get());
 
-    if (r->virtual_enabled)
-        draw_batches_virtual(r);
+    if (r->virtual_enabled || post_fx::any(&r->post))
+        draw_batches_offscreen(r);
     else
         draw_batches_direct(r);
 
@@ -90,59 +101,19 @@ void set_virtual_resolution(Renderer2D* r, int width, int height)
 {
     LOG_INFO("Renderer: enabling virtual resolution  {}x{}", width, height);
 
-    if (r->virtual_enabled)
-    {
-        glDeleteFramebuffers(1, &r->virtual_fbo);
-        glDeleteTextures(1, &r->virtual_color);
-        glDeleteRenderbuffers(1, &r->virtual_rbo);
-    }
-
     if (width <= 0 || height <= 0)
     {
         LOG_ERROR("Renderer: invalid virtual resolution  {}x{}", width, height);
         return;
     }
 
+    // The scene target itself is pooled by the render graph
     r->virtual_width = width;
     r->virtual_height = height;
     r->virtual_enabled = true;
-
-    glGenFramebuffers(1, &r->virtual_fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, r->virtual_fbo);
-    // GL_CHECK();
-
-    // Texture
-    glGenTextures(1, &r->virtual_color);
-    glBindTexture(GL_TEXTURE_2D, r->virtual_color);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, r->virtual_color, 0);
-    // GL_CHECK();
-
-    // Depth/stencil
-    glGenRenderbuffers(1, &r->virtual_rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, r->virtual_rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, r->virtual_rbo);
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        LOG_WARN("Renderer: virtual framebuffer incomplete!");
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void disable_virtual_resolution(Renderer2D* r)
-{
-    if (!r->virtual_enabled) return;
-
-    glDeleteFramebuffers(1, &r->virtual_fbo);
-    glDeleteTextures(1, &r->virtual_color);
-    glDeleteRenderbuffers(1, &r->virtual_rbo);
-    r->virtual_enabled = false;
-}
+void disable_virtual_resolution(Renderer2D* r) { r->virtual_enabled = false; }
 
 void compute_virtual_scaling(Renderer2D* r, int window_w, int window_h)
 {
@@ -222,68 +193,84 @@ void draw_batches_direct(Renderer2D* r)
 {
     int w, h;
     glfwGetFramebufferSize(r->window, &w, &h);
-    glViewport(0, 0, w, h);
+    gl_state::viewport(&r->gl, 0, 0, w, h);
     glClearColor(0.04f, 0.04f, 0.06f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // glUseProgram(shader);
+    gl_state::use_program(&r->gl, r->shader.program);
     float aspect = float(w) / float(h);
-    glUniform1f(glGetUniformLocation(r->shader, "uAspect"), aspect);
+    resource::set_uniform(r->shader, r->loc_aspect, aspect);
 
     setup_projection_matrix(r, w, h);
-    glUniformMatrix4fv(glGetUniformLocation(r->shader, "uProjection"), 1, GL_FALSE, &r->projection[0][0]);
+    resource::set_uniform(r->shader, r->loc_projection, r->projection);
     draw_batches(r);
     flush_cpu_vertices(r);
+    particles::draw(&r->particles, &r->gl, r->projection);
 }
 
-void draw_batches_virtual(Renderer2D* r)
+void draw_batches_offscreen(Renderer2D* r)
 {
-    glDisable(GL_DEPTH_TEST);
-    glBindFramebuffer(GL_FRAMEBUFFER, r->virtual_fbo);
-    // GL_CHECK();
-    glViewport(0, 0, r->virtual_width, r->virtual_height);
-    glClearColor(0.04f, 0.04f, 0.06f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    glUseProgram(r->shader);
-    glBindVertexArray(r->vao);
-    float aspect = float(r->virtual_width) / float(r->virtual_height);
-    glUniform1f(glGetUniformLocation(r->shader, "uAspect"), aspect);
-
-    setup_projection_matrix(r, r->virtual_width, r->virtual_height);
-    glUniformMatrix4fv(glGetUniformLocation(r->shader, "uProjection"), 1, GL_FALSE, &r->projection[0][0]);
-    draw_batches(r);
-    flush_cpu_vertices(r);
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
     int w, h;
     glfwGetFramebufferSize(r->window, &w, &h);
-    compute_virtual_scaling(r, w, h);
-
-    glViewport(0, 0, w, h);
-    glClearColor(0, 0, 0, 1);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    glUseProgram(r->blit_shader);
-    GLint scale_loc = glGetUniformLocation(r->blit_shader, "uFinalScale");
-    GLint offset_loc = glGetUniformLocation(r->blit_shader, "uFinalOffset");
-    GLint window_loc = glGetUniformLocation(r->blit_shader, "uWindowSize");
-    GLint virtual_size = glGetUniformLocation(r->blit_shader, "uVirtualSize");
 
-    glUniform2f(virtual_size, r->virtual_width, r->virtual_height);
-    glUniform2f(scale_loc, r->final_scale.x, r->final_scale.y);
-    glUniform2f(offset_loc, r->final_offset.x, r->final_offset.y);
-    glUniform2f(window_loc, (float) w, (float) h);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, r->virtual_color);
+    int scene_w = w;
+    int scene_h = h;
+    if (r->virtual_enabled)
+    {
+        scene_w = r->virtual_width;
+        scene_h = r->virtual_height;
+        compute_virtual_scaling(r, w, h);
+    }
+    else
+    {
+        r->final_scale = vec2(1);
+        r->final_offset = vec2(0);
+    }
 
-    glBindVertexArray(r->blit_vao);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    RenderGraph* g = &r->graph;
+    render_graph::begin(g, w, h);
+
+    TargetId scene = render_graph::create_target(g, {scene_w, scene_h});
+    render_graph::add_pass(g, "scene", {}, scene,
+                           [r, scene_w, scene_h](RenderGraph*, const RenderPass&)
+                           {
+                               glClearColor(0.04f, 0.04f, 0.06f, 1.0f);
+                               glClear(GL_COLOR_BUFFER_BIT);
+
+                               gl_state::use_program(&r->gl, r->shader.program);
+                               resource::set_uniform(r->shader, r->loc_aspect, float(scene_w) / float(scene_h));
+
+                               setup_projection_matrix(r, scene_w, scene_h);
+                               resource::set_uniform(r->shader, r->loc_projection, r->projection);
+                               draw_batches(r);
+                               flush_cpu_vertices(r);
+                               particles::draw(&r->particles, &r->gl, r->projection);
+                           });
+
+    TargetId result = post_fx::add_passes(&r->post, g, &r->gl, r->blit_vao, scene);
+
+    render_graph::add_pass(g, "present", {result}, BACKBUFFER,
+                           [r, w, h, scene_w, scene_h](RenderGraph* graph, const RenderPass& pass)
+                           {
+                               glClearColor(0, 0, 0, 1);
+                               glClear(GL_COLOR_BUFFER_BIT);
+
+                               resource::Shader& s = r->blit_shader;
+                               gl_state::use_program(&r->gl, s.program);
+                               resource::set_uniform(s, r->loc_virtual_size, vec2(scene_w, scene_h));
+                               resource::set_uniform(s, r->loc_final_scale, r->final_scale);
+                               resource::set_uniform(s, r->loc_final_offset, r->final_offset);
+                               resource::set_uniform(s, r->loc_window_size, vec2(w, h));
+
+                               gl_state::bind_texture(&r->gl, 0, render_graph::texture(graph, pass.reads[0]));
+                               gl_state::bind_vertex_array(&r->gl, r->blit_vao);
+                               glDrawArrays(GL_TRIANGLES, 0, 6);
+                           });
+
+    render_graph::compile(g, &r->gl);
+    render_graph::execute(g, &r->gl);
 
     set_texture(r, 0);
-    glEnable(GL_DEPTH_TEST);
 }
 
 void create_gl_objects(Renderer2D* r)
@@ -293,9 +280,9 @@ void create_gl_objects(Renderer2D* r)
     glGenVertexArrays(1, &r->vao);
     glGenBuffers(1, &r->vbo);
 
-    glBindVertexArray(r->vao);
+    gl_state::bind_vertex_array(&r->gl, r->vao);
     // GL_CHECK();
-    glBindBuffer(GL_ARRAY_BUFFER, r->vbo);
+    gl_state::bind_array_buffer(&r->gl, r->vbo);
     // GL_CHECK();
     glBufferData(GL_ARRAY_BUFFER, r->MAX_VERTICES * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
 
@@ -315,7 +302,7 @@ void create_gl_objects(Renderer2D* r)
 
 #undef ATTR
 
-    glBindVertexArray(0);
+    gl_state::bind_vertex_array(&r->gl, 0);
 }
 
 void destroy_gl_objects(Renderer2D* r)
@@ -329,8 +316,8 @@ void create_blit_objects(Renderer2D* r)
     glGenVertexArrays(1, &r->blit_vao);
     glGenBuffers(1, &r->blit_vbo);
 
-    glBindVertexArray(r->blit_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, r->blit_vbo);
+    gl_state::bind_vertex_array(&r->gl, r->blit_vao);
+    gl_state::bind_array_buffer(&r->gl, r->blit_vbo);
 
     glBufferData(GL_ARRAY_BUFFER, sizeof(blit_vertices), blit_vertices, GL_STATIC_DRAW);
 
@@ -342,7 +329,7 @@ void create_blit_objects(Renderer2D* r)
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(BlitVertex), (void*) offsetof(BlitVertex, uv));
     glEnableVertexAttribArray(1);
 
-    glBindVertexArray(0);
+    gl_state::bind_vertex_array(&r->gl, 0);
 }
 
 void destroy_blit_objects(Renderer2D* r)
@@ -392,11 +379,10 @@ void flush_cpu_vertices(Renderer2D* r)
         return;
     }
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, r->current_texture ? r->current_texture : 0);
-    glBindVertexArray(r->vao);
+    gl_state::bind_texture(&r->gl, 0, r->current_texture);
+    gl_state::bind_vertex_array(&r->gl, r->vao);
     // GL_CHECK();
-    glBindBuffer(GL_ARRAY_BUFFER, r->vbo);
+    gl_state::bind_array_buffer(&r->gl, r->vbo);
     glBufferSubData(GL_ARRAY_BUFFER, 0, r->cpu_vertices.size() * sizeof(Vertex), r->cpu_vertices.data());
 
     glDrawArrays(GL_TRIANGLES, 0, r->cpu_vertices.size());
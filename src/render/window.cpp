@@ -20,6 +20,7 @@ void create(int width, int height, const char* title)
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
     glfwWindowHint(GLFW_FLOATING, GLFW_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, headless ? GLFW_FALSE : GLFW_TRUE);
 
     window = glfwCreateWindow(width, height, title, nullptr, nullptr);
     LOG_INFO("Window: creating GLFW window");
@@ -31,7 +32,7 @@ void create(int width, int height, const char* title)
     }
 
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);  // vsync
+    glfwSwapInterval(headless ? 0 : 1);  // vsync, unless frames should run flat out
 
     if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress))
     {
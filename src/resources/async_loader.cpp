@@ -0,0 +1,269 @@
+#include "kine/resources/async_loader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "kine/resources/resource_manager.hpp"
+
+namespace kine::resource
+{
+
+namespace async
+{
+    struct DecodeJob
+    {
+        TextureHandle handle;
+        std::string name;
+        std::string path;
+        std::span<const std::byte> packed;  // Set instead of path for packed assets
+    };
+
+    struct Decoded
+    {
+        TextureHandle handle;
+        std::string name;
+        texture_cache::CookedTexture cooked;
+        bool ok = false;
+    };
+
+    static std::vector<std::thread> workers;
+
+    // Guards jobs, uploads and stopping
+    static std::mutex mutex;
+    static std::condition_variable job_cv;    // jobs gained an entry or stopping
+    static std::condition_variable space_cv;  // uploads lost an entry or stopping
+    static std::condition_variable ready_cv;  // uploads gained an entry
+    static std::deque<DecodeJob> jobs;
+    static std::deque<Decoded> uploads;
+    static bool stopping = false;
+
+    // GL thread only
+    static std::unordered_map<std::uint64_t, std::vector<TextureCallback>> callbacks;
+    static std::size_t in_flight = 0;
+
+    static bool read_bytes(const std::string& path, std::vector<std::byte>& out)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+
+        out.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        return bool(file.read(reinterpret_cast<char*>(out.data()), std::streamsize(out.size())));
+    }
+
+    static void worker_main()
+    {
+        while (true)
+        {
+            DecodeJob job;
+            {
+                std::unique_lock lock(mutex);
+                job_cv.wait(lock, [] { return stopping || !jobs.empty(); });
+                if (stopping) return;
+
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            Decoded out;
+            out.handle = job.handle;
+            out.name = std::move(job.name);
+
+            std::vector<std::byte> storage;
+            if (job.packed.empty() && read_bytes(job.path, storage)) job.packed = storage;
+
+            // Decode and mip generation (or the cooked cache read) all happen here, off the GL thread
+            out.ok = !job.packed.empty() && texture_cache::decode(job.packed, out.cooked);
+            if (!out.ok) LOG_ERROR("TextureManager: Failed to load texture {}", out.name);
+
+            {
+                std::unique_lock lock(mutex);
+                space_cv.wait(lock, [] { return stopping || uploads.size() < upload_capacity; });
+                if (stopping) return;
+                uploads.push_back(std::move(out));
+            }
+            ready_cv.notify_one();
+        }
+    }
+
+    void init(unsigned count)
+    {
+        if (!workers.empty()) return;
+
+        // hardware_concurrency() may return 0, which must not wrap around
+        const unsigned hw = std::thread::hardware_concurrency();
+        if (count == 0) count = std::max(1u, hw > 1 ? hw - 1 : 1u);
+
+        stopping = false;
+        workers.reserve(count);
+        for (unsigned i = 0; i < count; ++i) workers.emplace_back(worker_main);
+
+        LOG_INFO("TextureManager: {} decode workers", count);
+    }
+
+    void shutdown()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        job_cv.notify_all();
+        space_cv.notify_all();
+
+        for (std::thread& t : workers) t.join();
+        workers.clear();
+
+        uploads.clear();
+        jobs.clear();
+        callbacks.clear();
+        in_flight = 0;
+    }
+
+    static std::uint64_t callback_key(TextureHandle h) { return (std::uint64_t(h.generation) << 32) | h.index; }
+
+    static void finish(Decoded& d)
+    {
+        --in_flight;
+
+        // Null if the texture was unloaded while it was decoding
+        Texture2D* tex = textures.get(d.handle);
+        if (!d.ok || !tex)
+        {
+            callbacks.erase(callback_key(d.handle));
+            return;
+        }
+
+        tex->id = 0;  // Still borrowing the error texture's id
+        upload_cooked(*tex, d.cooked);
+        tex->ready = true;
+
+        auto cb = callbacks.find(callback_key(d.handle));
+        if (cb == callbacks.end()) return;
+
+        std::vector<TextureCallback> ready = std::move(cb->second);
+        callbacks.erase(cb);
+        for (TextureCallback& fn : ready) fn(*tex);
+    }
+
+    // Upload queued textures until the queue is empty or the budget is spent
+    static void drain(float budget_ms)
+    {
+        using clock = std::chrono::steady_clock;
+        const auto start = clock::now();
+
+        while (true)
+        {
+            Decoded d;
+            {
+                std::lock_guard lock(mutex);
+                if (uploads.empty()) return;
+
+                d = std::move(uploads.front());
+                uploads.pop_front();
+            }
+            space_cv.notify_one();
+
+            finish(d);
+
+            std::chrono::duration<float, std::milli> spent = clock::now() - start;
+            if (spent.count() >= budget_ms) return;
+        }
+    }
+
+    void pump()
+    {
+        if (in_flight) drain(upload_budget_ms);
+    }
+
+    std::size_t pending() { return in_flight; }
+
+    void wait_all()
+    {
+        while (in_flight)
+        {
+            {
+                std::unique_lock lock(mutex);
+                ready_cv.wait(lock, [] { return !uploads.empty(); });
+            }
+            drain(std::numeric_limits<float>::max());
+        }
+    }
+}  // namespace async
+
+TextureHandle load_texture_async(const std::string& name, const std::string& file, TextureCallback on_ready)
+{
+    if (TextureHandle h = textures.find(name))
+    {
+        textures.acquire(h);
+
+        Texture2D* tex = textures.get(h);
+        if (!on_ready || !tex) return h;
+
+        if (tex->ready)
+            on_ready(*tex);
+        else
+            async::callbacks[async::callback_key(h)].push_back(std::move(on_ready));
+        return h;
+    }
+
+    LOG_INFO("TextureManager: Queueing texture {}", name);
+
+    Texture2D tex;
+    tex.id = error_texture->id;
+    tex.width = error_texture->width;
+    tex.height = error_texture->height;
+    tex.name = name;
+    tex.ready = false;
+
+    TextureHandle h = textures.insert(name, std::move(tex));
+    texture_sources[name] = file;
+
+    if (on_ready) async::callbacks[async::callback_key(h)].push_back(std::move(on_ready));
+
+    async::requeue(h);
+    return h;
+}
+
+void async::requeue(TextureHandle handle)
+{
+    Texture2D* tex = textures.get(handle);
+    if (!tex) return;
+
+    auto src = texture_sources.find(tex->name);
+    if (src == texture_sources.end()) return;
+
+    // Resolve on the caller's thread, the index and packs are not shared with the workers.
+    // Pack views stay mapped until resource::shutdown(), which stops the workers first.
+    std::span<const std::byte> packed = find_packed(src->second);
+    std::string path;
+    if (packed.empty())
+    {
+        // The file may have left the index since the first load (hot reload, pack unmounted)
+        auto file = file_index.find(src->second);
+        if (file == file_index.end())
+        {
+            LOG_WARN("TextureManager: {} not indexed, {} stays on the error texture", src->second, tex->name);
+            return;
+        }
+        path = file->second;
+    }
+
+    if (workers.empty()) init();
+
+    ++in_flight;
+    {
+        std::lock_guard lock(mutex);
+        jobs.push_back({handle, tex->name, std::move(path), packed});
+    }
+    job_cv.notify_one();
+}
+
+}  // namespace kine::resource
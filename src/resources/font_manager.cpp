@@ -5,16 +5,13 @@
 namespace kine::resource
 {
 
-Font& load_font(const std::string& name, const std::string& file, int pixel_height)
+// Render the glyph atlas of bytes into font and upload it into tex (allocating tex.id if needed)
+static bool rasterize(Font& font, Texture2D& tex, std::span<const std::byte> bytes, int pixel_height)
 {
-    if (fonts.contains(name)) return fonts.at(name);
-
-    LOG_INFO("FontManager: Loading font {}", name);
-
     FT_Face face{};
-    const std::string path = resource::get_path(file);
-
-    if (FT_New_Face(library, path.c_str(), 0, &face)) LOG_THROW("FreeType: Failed to load font {}", path);
+    if (FT_New_Memory_Face(library, reinterpret_cast<const FT_Byte*>(bytes.data()), static_cast<FT_Long>(bytes.size()),
+                           0, &face))
+        return false;
 
     FT_Set_Pixel_Sizes(face, 0, pixel_height);
 
@@ -38,7 +35,7 @@ Font& load_font(const std::string& name, const std::string& file, int pixel_heig
 
     uint32_t x_offset = 0;
 
-    Font font{};
+    font.glyphs.clear();
     font.line_height = static_cast<float>(face->size->metrics.height >> 6);
     font.ascent = static_cast<float>(face->size->metrics.ascender >> 6);
 
@@ -74,12 +71,10 @@ Font& load_font(const std::string& name, const std::string& file, int pixel_heig
     }
 
     // Upload texture
-    Texture2D tex{};
-    tex.name = name;
     tex.width = atlas_w;
     tex.height = atlas_h;
 
-    glGenTextures(1, &tex.id);
+    if (!tex.id) glGenTextures(1, &tex.id);
     glBindTexture(GL_TEXTURE_2D, tex.id);
 
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -91,21 +86,86 @@ Font& load_font(const std::string& name, const std::string& file, int pixel_heig
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     glBindTexture(GL_TEXTURE_2D, 0);
-
-    add_texture(name, std::move(tex));
-    font.texture = &get_texture(name);
+    residency::account(tex, std::size_t(atlas_w) * atlas_h);
 
     FT_Done_Face(face);
+    return true;
+}
+
+FontHandle load_font(const std::string& name, const std::string& file, int pixel_height)
+{
+    if (FontHandle h = fonts.find(name))
+    {
+        fonts.acquire(h);
+        return h;
+    }
+
+    LOG_INFO("FontManager: Loading font {}", name);
+
+    // Must outlive the face, FreeType reads from it directly
+    AssetData data = read_asset(file);
+
+    Font font{};
+    Texture2D tex{};
+    tex.name = name;
+    if (!rasterize(font, tex, data.bytes, pixel_height)) LOG_THROW("FreeType: Failed to load font {}", file);
+
+    TextureHandle atlas = add_texture(name, std::move(tex));
+    font.texture = &get_texture(atlas);
+    font_sources[name] = {file, pixel_height, atlas};
 
-    fonts.emplace(name, std::move(font));
-    return fonts.at(name);
+    return fonts.insert(name, std::move(font));
+}
+
+bool reload_font(const std::string& name)
+{
+    Font* font = fonts.get(fonts.find(name));
+    auto src = font_sources.find(name);
+    if (!font || src == font_sources.end()) return false;
+
+    AssetData data = read_asset(src->second.file);
+
+    // Glyphs and atlas are replaced in place, the Font and its texture id stay the same
+    Font fresh{};
+    if (!rasterize(fresh, *font->texture, data.bytes, src->second.pixel_height))
+    {
+        LOG_ERROR("FreeType: Failed to reload font {}", src->second.file);
+        return false;
+    }
+
+    fresh.texture = font->texture;
+    *font = std::move(fresh);
+    return true;
+}
+
+FontHandle find_font(const std::string& name) { return fonts.find(name); }
+
+Font& get_font(FontHandle handle)
+{
+    if (Font* font = fonts.get(handle)) return *font;
+
+    LOG_THROW("FontManager: Stale font handle");
 }
 
 Font& get_font(const std::string& name)
 {
-    if (fonts.contains(name)) return fonts.at(name);
+    if (Font* font = fonts.get(fonts.find(name))) return *font;
+
+    LOG_THROW("FontManager: Font not found {}", name);
+}
+
+void unload_font(FontHandle handle)
+{
+    if (!fonts.contains(handle) || fonts.release(handle) > 0) return;
 
-    LOG_ERROR("FontManager: Font not found {}", name);
-    return fonts.begin()->second;
+    const std::string name = fonts.name(handle);
+    if (auto src = font_sources.find(name); src != font_sources.end())
+    {
+        destroy_texture(src->second.atlas);
+        font_sources.erase(src);
+    }
+
+    fonts.erase(handle);
 }
+
 }  // namespace kine::resource
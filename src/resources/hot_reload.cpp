@@ -0,0 +1,185 @@
+#include "kine/resources/hot_reload.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "kine/resources/resource_manager.hpp"
+
+#if defined(__linux__)
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace kine::resource::hot_reload
+{
+
+#if defined(__linux__)
+
+struct Watch
+{
+    fs::path dir;
+    std::string key_prefix;  // Relative to the search root, '/'-separated
+};
+
+static constexpr std::uint32_t DIR_EVENTS =
+    IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_DELETE_SELF;
+
+static int inotify_fd = -1;
+static std::unordered_map<int, Watch> watches;
+
+static bool indexed_extension(const std::string& name);
+
+// Watch dir and its subdirectories. With found set, files already in them are indexed
+// and reported too, since they may have landed before the watch existed.
+static void watch_tree(const fs::path& dir, const std::string& key_prefix,
+                       std::unordered_set<std::string>* found = nullptr)
+{
+    int wd = inotify_add_watch(inotify_fd, dir.c_str(), DIR_EVENTS);
+    if (wd < 0)
+    {
+        LOG_WARN("HotReload: Failed to watch {}", dir.string());
+        return;
+    }
+    watches[wd] = {dir, key_prefix};
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec))
+    {
+        std::error_code type_ec;
+        const std::string name = entry.path().filename().string();
+
+        if (entry.is_directory(type_ec) && !entry.is_symlink(type_ec))
+            watch_tree(entry.path(), key_prefix + name + '/', found);
+        else if (found && entry.is_regular_file(type_ec) && indexed_extension(name))
+        {
+            file_index[key_prefix + name] = entry.path().string();
+            found->insert(key_prefix + name);
+        }
+    }
+}
+
+static bool indexed_extension(const std::string& name)
+{
+    const std::size_t dot = name.rfind('.');
+    if (dot == std::string::npos || dot == 0) return false;
+
+    return std::find(extensions.begin(), extensions.end(), name.substr(dot)) != extensions.end();
+}
+
+static void reload_dependents(const std::string& key)
+{
+    for (const auto& [name, file] : texture_sources)
+        if (file == key && reload_texture(name)) LOG_INFO("HotReload: Reloaded texture {}", name);
+
+    for (const auto& [name, src] : shader_sources)
+        if ((src.vertex == key || src.fragment == key) && reload_shader(name))
+            LOG_INFO("HotReload: Reloaded shader {}", name);
+
+    for (const auto& [name, src] : font_sources)
+        if (src.file == key && reload_font(name)) LOG_INFO("HotReload: Reloaded font {}", name);
+}
+
+void start()
+{
+    if (inotify_fd >= 0) return;
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0)
+    {
+        LOG_WARN("HotReload: inotify unavailable");
+        return;
+    }
+
+    const fs::path exe_dir = get_executable_dir();
+    for (const std::string& search_dir : search_dirs)
+    {
+        fs::path root = exe_dir / search_dir;
+        if (fs::is_directory(root)) watch_tree(root, "");
+    }
+
+    LOG_INFO("HotReload: Watching {} directories", watches.size());
+}
+
+void stop()
+{
+    if (inotify_fd < 0) return;
+
+    close(inotify_fd);
+    inotify_fd = -1;
+    watches.clear();
+}
+
+void poll()
+{
+    if (inotify_fd < 0) return;
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    std::unordered_set<std::string> changed;
+
+    ssize_t len;
+    while ((len = read(inotify_fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char* p = buffer; p < buffer + len;)
+        {
+            const auto* ev = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW)
+            {
+                LOG_WARN("HotReload: Event queue overflowed, some changes were missed");
+                continue;
+            }
+
+            auto it = watches.find(ev->wd);
+            if (it == watches.end()) continue;
+
+            if (ev->mask & (IN_IGNORED | IN_DELETE_SELF))
+            {
+                watches.erase(it);
+                continue;
+            }
+
+            if (ev->len == 0) continue;
+
+            const std::string name = ev->name;
+            const fs::path path = it->second.dir / name;
+            const std::string key = it->second.key_prefix + name;
+
+            if (ev->mask & IN_ISDIR)
+            {
+                if (ev->mask & (IN_CREATE | IN_MOVED_TO)) watch_tree(path, key + '/', &changed);
+                continue;
+            }
+
+            if (!indexed_extension(name)) continue;
+
+            if (ev->mask & (IN_DELETE | IN_MOVED_FROM))
+            {
+                file_index.erase(key);
+                changed.erase(key);
+            }
+            else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+            {
+                file_index[key] = path.string();
+                changed.insert(key);
+            }
+        }
+    }
+
+    // Editors often save a file in several steps; each key reloads once per poll
+    for (const std::string& key : changed) reload_dependents(key);
+}
+
+#else
+
+void start() { LOG_DEBUG("HotReload: Not supported on this platform"); }
+void stop() {}
+void poll() {}
+
+#endif
+
+}  // namespace kine::resource::hot_reload
@@ -0,0 +1,309 @@
+#include "kine/resources/pack.hpp"
+
+#include <brotli/decode.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include "kine/log.hpp"
+
+#if defined(_WIN32)
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace kine::pack
+{
+
+bool map_file(MappedFile* f, const std::string& path)
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    f->file = file;
+    f->mapping = mapping;
+    f->data = static_cast<const std::byte*>(view);
+    f->size = static_cast<std::size_t>(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+
+    f->data = static_cast<const std::byte*>(view);
+    f->size = static_cast<std::size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void unmap_file(MappedFile* f)
+{
+    if (!f->data) return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(f->data);
+    CloseHandle(f->mapping);
+    CloseHandle(f->file);
+    f->mapping = nullptr;
+    f->file = nullptr;
+#else
+    munmap(const_cast<std::byte*>(f->data), f->size);
+#endif
+
+    f->data = nullptr;
+    f->size = 0;
+}
+
+// [offset, offset + size) inside [0, total), without overflowing on hostile values
+static bool in_range(std::uint64_t offset, std::uint64_t size, std::uint64_t total)
+{
+    return offset <= total && size <= total - offset;
+}
+
+static bool valid_layout(const MappedFile& f)
+{
+    if (f.size < sizeof(Header)) return false;
+
+    const auto* header = reinterpret_cast<const Header*>(f.data);
+    if (header->magic != MAGIC || header->version != VERSION || header->entries_offset % alignof(Entry) != 0)
+        return false;
+    if (!in_range(header->entries_offset, std::uint64_t(header->entry_count) * sizeof(Entry), f.size)) return false;
+    if (!in_range(header->names_offset, header->names_size, f.size)) return false;
+
+    // Checked once here so entry_name() and read() can trust every entry
+    const auto* entries = reinterpret_cast<const Entry*>(f.data + header->entries_offset);
+    for (std::uint32_t i = 0; i < header->entry_count; ++i)
+    {
+        const Entry& e = entries[i];
+        if (!in_range(e.name_offset, e.name_size, header->names_size) || !in_range(e.offset, e.size, f.size))
+            return false;
+    }
+    return true;
+}
+
+bool open(Pack* p, const std::string& path)
+{
+    if (!map_file(&p->file, path)) return false;
+
+    if (!valid_layout(p->file))
+    {
+        LOG_ERROR("Pack: {} is not a valid pack", path);
+        unmap_file(&p->file);
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const Header*>(p->file.data);
+    p->path = path;
+    p->header = header;
+    p->entries = reinterpret_cast<const Entry*>(p->file.data + header->entries_offset);
+    p->names = reinterpret_cast<const char*>(p->file.data + header->names_offset);
+    return true;
+}
+
+void close(Pack* p)
+{
+    unmap_file(&p->file);
+    p->header = nullptr;
+    p->entries = nullptr;
+    p->names = nullptr;
+    p->decoded.clear();
+}
+
+std::string_view entry_name(const Pack* p, const Entry& e) { return {p->names + e.name_offset, e.name_size}; }
+
+const Entry* find(const Pack* p, std::string_view name)
+{
+    if (!p->header) return nullptr;
+
+    const std::uint64_t h = hash(name);
+    const Entry* first = p->entries;
+    const Entry* last = p->entries + p->header->entry_count;
+
+    const Entry* it = std::lower_bound(first, last, h, [](const Entry& e, std::uint64_t v) { return e.hash < v; });
+    for (; it != last && it->hash == h; ++it)
+        if (entry_name(p, *it) == name) return it;
+
+    return nullptr;
+}
+
+static bool decode_brotli(std::span<const std::byte> in, std::size_t raw_size, std::vector<std::byte>& out)
+{
+    BrotliDecoderState* state = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+    if (!state) return false;
+
+    std::size_t avail_in = in.size();
+    const auto* next_in = reinterpret_cast<const std::uint8_t*>(in.data());
+
+    out.resize(raw_size ? raw_size : std::max<std::size_t>(in.size() * 4, 4096));
+    std::size_t total = 0;
+
+    BrotliDecoderResult result;
+    do
+    {
+        if (total == out.size()) out.resize(out.size() * 2);
+
+        std::size_t avail_out = out.size() - total;
+        auto* next_out = reinterpret_cast<std::uint8_t*>(out.data() + total);
+        result = BrotliDecoderDecompressStream(state, &avail_in, &next_in, &avail_out, &next_out, nullptr);
+        total = out.size() - avail_out;
+    } while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT);
+
+    BrotliDecoderDestroyInstance(state);
+    out.resize(total);
+    return result == BROTLI_DECODER_RESULT_SUCCESS;
+}
+
+std::span<const std::byte> read(Pack* p, std::string_view name)
+{
+    const Entry* e = find(p, name);
+    if (!e) return {};
+
+    if (e->offset + e->size > p->file.size)
+    {
+        LOG_ERROR("Pack: {} entry {} is out of bounds", p->path, name);
+        return {};
+    }
+
+    std::span<const std::byte> stored(p->file.data + e->offset, e->size);
+    if (e->compression == Compression::None) return stored;
+
+    if (auto it = p->decoded.find(e->hash); it != p->decoded.end()) return it->second;
+
+    std::vector<std::byte> out;
+    if (e->compression != Compression::Brotli || !decode_brotli(stored, e->raw_size, out))
+    {
+        LOG_ERROR("Pack: Failed to decode {} from {}", name, p->path);
+        return {};
+    }
+
+    return p->decoded.emplace(e->hash, std::move(out)).first->second;
+}
+
+bool write(const std::string& path, std::vector<Source> sources)
+{
+    // Equal names end up adjacent even if another name shares their hash
+    std::sort(sources.begin(), sources.end(),
+              [](const Source& a, const Source& b)
+              {
+                  const std::uint64_t ha = hash(a.name);
+                  const std::uint64_t hb = hash(b.name);
+                  return ha != hb ? ha < hb : a.name < b.name;
+              });
+
+    std::vector<Entry> entries(sources.size());
+    std::string names;
+
+    for (std::size_t i = 0; i < sources.size(); ++i)
+    {
+        const Source& src = sources[i];
+        if (i > 0 && src.name == sources[i - 1].name)
+        {
+            LOG_ERROR("Pack: {} is a duplicate entry", src.name);
+            return false;
+        }
+
+        std::error_code ec;
+        const std::uintmax_t size = std::filesystem::file_size(src.path, ec);
+        if (ec)
+        {
+            LOG_ERROR("Pack: Failed to stat {}", src.path);
+            return false;
+        }
+
+        Entry& e = entries[i];
+        e.hash = hash(src.name);
+        e.size = size;
+        e.raw_size = src.compression == Compression::None ? size : 0;
+        e.compression = src.compression;
+        e.name_offset = static_cast<std::uint32_t>(names.size());
+        e.name_size = static_cast<std::uint32_t>(src.name.size());
+        names += src.name;
+    }
+
+    auto align = [](std::uint64_t v) { return (v + DATA_ALIGN - 1) & ~std::uint64_t(DATA_ALIGN - 1); };
+
+    Header header;
+    header.entry_count = static_cast<std::uint32_t>(entries.size());
+    header.names_size = static_cast<std::uint32_t>(names.size());
+    header.entries_offset = sizeof(Header);
+    header.names_offset = header.entries_offset + entries.size() * sizeof(Entry);
+
+    std::uint64_t cursor = align(header.names_offset + names.size());
+    for (Entry& e : entries)
+    {
+        e.offset = cursor;
+        cursor = align(cursor + e.size);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        LOG_ERROR("Pack: Failed to create {}", path);
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), std::streamsize(entries.size() * sizeof(Entry)));
+    out.write(names.data(), std::streamsize(names.size()));
+
+    std::vector<char> buffer;
+    for (std::size_t i = 0; i < sources.size(); ++i)
+    {
+        const Entry& e = entries[i];
+        std::ifstream in(sources[i].path, std::ios::binary);
+        buffer.resize(e.size);
+        if (!in.read(buffer.data(), std::streamsize(e.size)))
+        {
+            LOG_ERROR("Pack: Failed to read {}", sources[i].path);
+            return false;
+        }
+
+        // Pad up to the entry's aligned offset
+        const std::streamoff pad = std::streamoff(e.offset) - out.tellp();
+        for (std::streamoff k = 0; k < pad; ++k) out.put('\0');
+
+        out.write(buffer.data(), std::streamsize(e.size));
+    }
+
+    return bool(out);
+}
+
+}  // namespace kine::pack
@@ -0,0 +1,122 @@
+#include "kine/resources/residency.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "kine/resources/resource_manager.hpp"
+
+namespace kine::resource::residency
+{
+
+static std::uint64_t current_frame = 1;
+static std::size_t resident_bytes = 0;
+static std::size_t evicted_count = 0;
+static std::size_t evictions = 0;
+static std::size_t reloads = 0;
+
+struct Candidate
+{
+    std::uint64_t last_used;
+    TextureHandle handle;
+};
+
+static std::vector<Candidate> candidates;
+
+Texture2D& use(TextureHandle handle)
+{
+    Texture2D& tex = peek_texture(handle);
+    tex.last_used = current_frame;
+
+    if (tex.evicted)
+    {
+        tex.evicted = false;
+        --evicted_count;
+        ++reloads;
+        async::requeue(handle);
+    }
+
+    return tex;
+}
+
+void account(Texture2D& tex, std::size_t bytes)
+{
+    resident_bytes = resident_bytes - tex.gpu_bytes + bytes;
+    tex.gpu_bytes = bytes;
+
+    // A fresh upload counts as a use, so it is not instantly stale
+    if (bytes) tex.last_used = std::max(tex.last_used, current_frame);
+}
+
+static void evict(Texture2D& tex)
+{
+    glDeleteTextures(1, &tex.id);
+    account(tex, 0);
+
+    // Same placeholder as a texture that is still loading
+    tex.id = error_texture->id;
+    tex.ready = false;
+    tex.evicted = true;
+
+    ++evicted_count;
+    ++evictions;
+}
+
+void update()
+{
+    const std::uint64_t frame_now = current_frame++;
+
+    // The age sweep runs a few times a second, the budget check whenever it is exceeded
+    const bool over_budget = resident_bytes > budget_bytes;
+    if (!over_budget && frame_now % 30 != 0) return;
+
+    candidates.clear();
+    textures.each(
+        [&](TextureHandle h, Texture2D& tex)
+        {
+            // Only file-backed textures can come back; atlases and generated textures stay, and so do pinned ones
+            const bool reloadable = h != error_handle && !tex.pinned && texture_sources.contains(tex.name);
+            if (tex.ready && tex.last_used < frame_now && reloadable)
+                candidates.push_back({tex.last_used, h});
+        });
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.last_used < b.last_used; });
+
+    for (const Candidate& c : candidates)
+    {
+        const bool stale = frame_now - c.last_used >= evict_after_frames;
+        if (!stale && resident_bytes <= budget_bytes) break;
+
+        if (Texture2D* tex = textures.get(c.handle)) evict(*tex);
+    }
+}
+
+void reset()
+{
+    current_frame = 1;
+    resident_bytes = 0;
+    evicted_count = 0;
+    evictions = 0;
+    reloads = 0;
+    candidates.clear();
+}
+
+Stats stats()
+{
+    Stats s;
+    s.budget_bytes = budget_bytes;
+    s.resident_bytes = resident_bytes;
+    s.evicted_count = evicted_count;
+    s.evictions = evictions;
+    s.reloads = reloads;
+    textures.each(
+        [&](TextureHandle, Texture2D& tex)
+        {
+            if (tex.gpu_bytes) ++s.resident_count;
+        });
+    return s;
+}
+
+std::uint64_t frame() { return current_frame; }
+
+}  // namespace kine::resource::residency
@@ -1,8 +1,12 @@
 #include "kine/resources/resource_manager.hpp"
 
 #include <algorithm>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 
 #include "kine/resources/error_texture.hpp"
 
@@ -48,39 +52,283 @@ fs::path get_executable_dir()
 void create()
 {
     search_dirs = {"assets/"};
-    extensions = {".vert", ".frag", ".glsl", ".png", ".jpg", ".ttf"};
+    extensions = {".vert", ".frag", ".glsl", ".png", ".jpg", ".ttf", ".wav", ".mp3", ".flac"};
 }
 
 void init()
 {
-    if (search_dirs.empty() || extensions.empty()) LOG_THROW("ResourceManager: search directories is not specified.");
+    if (texture_cache::dir.empty()) texture_cache::dir = (get_executable_dir() / ".cache" / "textures").string();
+    if (program_cache_dir.empty()) program_cache_dir = (get_executable_dir() / ".cache" / "programs").string();
 
-    build();
+    const bool packed = !default_pack.empty() && mount((get_executable_dir() / default_pack).string());
 
-    LOG_INFO("ResourceManager: Indexed {} files", file_index.size());
+    if (!packed)
+    {
+        if (search_dirs.empty() || extensions.empty())
+            LOG_THROW("ResourceManager: search directories is not specified.");
+
+        build();
+
+        LOG_INFO("ResourceManager: Indexed {} files", file_index.size());
+    }
 
     // error_texture = &load_texture("error", "error.png");
-    error_texture = &load_embedded_texture("error", error_compressed_data, error_compressed_size);
+    error_handle = load_embedded_texture("error", error_compressed_data, error_compressed_size);
+    error_texture = textures.get(error_handle);
+    if (!error_texture) LOG_THROW("ResourceManager: Failed to decode the error texture");
     FT_Init_FreeType(&library);
+
+    async::init();
+
+    if (hot_reload::enabled && packs.empty()) hot_reload::start();
 }
 
 void shutdown()
 {
+    hot_reload::stop();
+    async::shutdown();
     file_index.clear();
 
-    for (auto& [_, tex] : textures)
-        if (tex.id) glDeleteTextures(1, &tex.id);
+    for (pack::Pack& p : packs) pack::close(&p);
+    packs.clear();
 
-    for (auto& [_, shader] : shaders) glDeleteProgram(shader.program);
+    // Textures still loading only borrow the error texture's id
+    textures.each(
+        [](TextureHandle, Texture2D& tex)
+        {
+            if (tex.id && tex.ready) glDeleteTextures(1, &tex.id);
+        });
+    residency::reset();
+    shaders.each([](ShaderHandle, Shader& shader) { glDeleteProgram(shader.program); });
+
+    textures.clear();
+    fonts.clear();
+    shaders.clear();
+    texture_sources.clear();
+    font_sources.clear();
+    shader_sources.clear();
+    error_texture = nullptr;
+    error_handle = {};
 
     FT_Done_FreeType(library);
 }
 
+struct IndexedDir
+{
+    std::string path;
+    std::int64_t mtime = -1;  // -1 if the directory did not exist
+};
+
+struct DirJob
+{
+    fs::path path;
+    std::string key_prefix;  // Relative to the search root, '/'-separated
+};
+
+static std::int64_t dir_mtime(const fs::path& dir)
+{
+    std::error_code ec;
+    auto time = fs::last_write_time(dir, ec);
+    return ec ? -1 : static_cast<std::int64_t>(time.time_since_epoch().count());
+}
+
+/**
+ * Walk root with a pool of threads, one directory per job.
+ *
+ * Every visited directory is recorded with its mtime: adding, removing or
+ * renaming an entry touches its parent, so these are enough to validate the
+ * cached index later.
+ */
+static void walk(const fs::path& root, const std::unordered_set<std::string>& exts,
+                 std::vector<std::pair<std::string, std::string>>& files, std::vector<IndexedDir>& dirs)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<DirJob> queue{{root, ""}};
+    std::size_t busy = 0;
+
+    auto worker = [&]
+    {
+        std::vector<DirJob> subdirs;
+        std::vector<std::pair<std::string, std::string>> found;
+
+        while (true)
+        {
+            DirJob job;
+            {
+                std::unique_lock lock(mutex);
+                cv.wait(lock, [&] { return !queue.empty() || busy == 0; });
+                if (queue.empty()) return;
+
+                job = std::move(queue.back());
+                queue.pop_back();
+                ++busy;
+            }
+
+            const std::int64_t mtime = dir_mtime(job.path);
+
+            std::error_code ec;
+            for (const auto& entry : fs::directory_iterator(job.path, ec))
+            {
+                std::error_code type_ec;
+                std::string name = entry.path().filename().string();
+
+                if (entry.is_directory(type_ec) && !entry.is_symlink(type_ec))
+                {
+                    subdirs.push_back({entry.path(), job.key_prefix + name + '/'});
+                    continue;
+                }
+
+                if (!entry.is_regular_file(type_ec)) continue;
+
+                const std::size_t dot = name.rfind('.');
+                if (dot == std::string::npos || dot == 0 || !exts.contains(name.substr(dot))) continue;
+
+                found.emplace_back(job.key_prefix + name, entry.path().string());
+            }
+
+            std::lock_guard lock(mutex);
+            dirs.push_back({job.path.string(), mtime});
+            files.insert(files.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+            queue.insert(queue.end(), std::make_move_iterator(subdirs.begin()), std::make_move_iterator(subdirs.end()));
+            found.clear();
+            subdirs.clear();
+            --busy;
+            cv.notify_all();
+        }
+    };
+
+    const unsigned count = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    threads.reserve(count - 1);
+    for (unsigned i = 1; i < count; ++i) threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads) t.join();
+}
+
+// Hash of everything that shapes the index besides the directory contents
+static std::uint64_t index_config(const fs::path& exe_dir)
+{
+    std::string key = exe_dir.string();
+    for (const std::string& dir : search_dirs) key += '\0' + dir;
+    key += '\1';
+    for (const std::string& ext : extensions) key += '\0' + ext;
+    return pack::hash(key);
+}
+
+static constexpr std::uint32_t INDEX_MAGIC = 0x5844494B;  // "KIDX"
+static constexpr std::uint32_t INDEX_VERSION = 1;
+
+static void write_string(std::ofstream& out, const std::string& s)
+{
+    const auto size = static_cast<std::uint32_t>(s.size());
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(s.data(), size);
+}
+
+static bool read_string(std::ifstream& in, std::string& s)
+{
+    std::uint32_t size = 0;
+    if (!in.read(reinterpret_cast<char*>(&size), sizeof(size))) return false;
+    s.resize(size);
+    return bool(in.read(s.data(), size));
+}
+
+template <typename T>
+static bool read_pod(std::ifstream& in, T& v)
+{
+    return bool(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+}
+
+static bool load_index_cache(const fs::path& path, std::uint64_t config)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    std::uint32_t magic = 0, version = 0;
+    std::uint64_t stored_config = 0, dir_count = 0, file_count = 0;
+    if (!read_pod(in, magic) || !read_pod(in, version) || !read_pod(in, stored_config) || magic != INDEX_MAGIC ||
+        version != INDEX_VERSION || stored_config != config)
+        return false;
+
+    // Only directories are stat'ed, nothing is listed
+    if (!read_pod(in, dir_count)) return false;
+    for (std::uint64_t i = 0; i < dir_count; ++i)
+    {
+        std::string dir;
+        std::int64_t mtime = 0;
+        if (!read_string(in, dir) || !read_pod(in, mtime) || dir_mtime(dir) != mtime) return false;
+    }
+
+    if (!read_pod(in, file_count)) return false;
+
+    std::unordered_map<std::string, std::string> index;
+    index.reserve(file_count);
+    for (std::uint64_t i = 0; i < file_count; ++i)
+    {
+        std::string key, file;
+        if (!read_string(in, key) || !read_string(in, file)) return false;
+        index.emplace(std::move(key), std::move(file));
+    }
+
+    file_index = std::move(index);
+    return true;
+}
+
+static void store_index_cache(const fs::path& path, std::uint64_t config, const std::vector<IndexedDir>& dirs)
+{
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+
+    fs::path tmp = path;
+    tmp += ".tmp";
+
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return;
+
+        out.write(reinterpret_cast<const char*>(&INDEX_MAGIC), sizeof(INDEX_MAGIC));
+        out.write(reinterpret_cast<const char*>(&INDEX_VERSION), sizeof(INDEX_VERSION));
+        out.write(reinterpret_cast<const char*>(&config), sizeof(config));
+
+        const std::uint64_t dir_count = dirs.size();
+        out.write(reinterpret_cast<const char*>(&dir_count), sizeof(dir_count));
+        for (const IndexedDir& dir : dirs)
+        {
+            write_string(out, dir.path);
+            out.write(reinterpret_cast<const char*>(&dir.mtime), sizeof(dir.mtime));
+        }
+
+        const std::uint64_t file_count = file_index.size();
+        out.write(reinterpret_cast<const char*>(&file_count), sizeof(file_count));
+        for (const auto& [key, file] : file_index)
+        {
+            write_string(out, key);
+            write_string(out, file);
+        }
+    }
+
+    fs::rename(tmp, path, ec);
+}
+
 void build()
 {
     file_index.clear();
     auto exe_dir = get_executable_dir();
 
+    const std::uint64_t config = index_config(exe_dir);
+    const fs::path cache_path = index_cache.empty() ? fs::path() : exe_dir / index_cache;
+
+    if (!cache_path.empty() && load_index_cache(cache_path, config))
+    {
+        LOG_DEBUG("ResourceManager: Using cached index {}", cache_path.string());
+        return;
+    }
+
+    const std::unordered_set<std::string> exts(extensions.begin(), extensions.end());
+    std::vector<IndexedDir> dirs;
+    std::vector<std::pair<std::string, std::string>> files;
+
     for (const auto& search_dir : search_dirs)
     {
         auto dir = (exe_dir / search_dir);
@@ -89,27 +337,23 @@ void build()
         if (!fs::exists(root))
         {
             LOG_WARN("ResourceManager: {} not found", dir.string());
+            dirs.push_back({root.string(), -1});
             continue;
         }
 
-        for (const auto& entry : fs::recursive_directory_iterator(root))
-        {
-            if (!entry.is_regular_file()) continue;
-
-            fs::path path = entry.path();
-            std::string ext = path.extension().string();
-
-            if (std::find(extensions.begin(), extensions.end(), ext) == extensions.end()) continue;
-
-            fs::path relative = fs::relative(path, root);
-            // relative.replace_extension("");
+        files.clear();
+        walk(root, exts, files, dirs);
 
-            std::string key = relative.generic_string();
+        file_index.reserve(file_index.size() + files.size());
+        for (auto& [key, path] : files)
+        {
             LOG_TRACE("ResourceManager: Indexing {}", key);
             if (file_index.contains(key)) LOG_WARN("ResourceManager: {} is duplicate asset key", key);
-            file_index[key] = path.string();
+            file_index[key] = std::move(path);
         }
     }
+
+    if (!cache_path.empty()) store_index_cache(cache_path, config, dirs);
 }
 
 const std::string& get_path(const std::string& name)
@@ -122,12 +366,60 @@ const std::string& get_path(const std::string& name)
 
 const std::string read_file(const std::string& path)
 {
-    std::ifstream file(path);
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
     if (!file) LOG_THROW("ResourceManager: Failed to open file {}", path);
 
-    std::stringstream ss;
-    ss << file.rdbuf();
-    return ss.str();
+    std::string data(static_cast<std::size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(data.data(), std::streamsize(data.size()));
+    return data;
+}
+
+bool mount(const std::string& path)
+{
+    pack::Pack& p = packs.emplace_back();
+    if (!pack::open(&p, path))
+    {
+        packs.pop_back();
+        return false;
+    }
+
+    LOG_INFO("ResourceManager: Mounted {} ({} entries)", path, p.header->entry_count);
+    return true;
+}
+
+bool exists(const std::string& name)
+{
+    for (const pack::Pack& p : packs)
+        if (pack::find(&p, name)) return true;
+
+    return file_index.contains(name);
+}
+
+std::span<const std::byte> find_packed(const std::string& name)
+{
+    for (auto it = packs.rbegin(); it != packs.rend(); ++it)
+        if (pack::find(&*it, name)) return pack::read(&*it, name);
+
+    return {};
+}
+
+AssetData read_asset(const std::string& name)
+{
+    AssetData data;
+    data.bytes = find_packed(name);
+    if (!data.bytes.empty()) return data;
+
+    const std::string& path = get_path(name);
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) LOG_THROW("ResourceManager: Failed to open file {}", path);
+
+    data.storage.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.storage.data()), std::streamsize(data.storage.size()));
+
+    data.bytes = data.storage;
+    return data;
 }
 
 }  // namespace kine::resource
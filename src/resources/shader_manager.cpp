@@ -1,40 +1,337 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <stdexcept>
 #include "kine/resources/resource_manager.hpp"
 
+namespace fs = std::filesystem;
+
 namespace kine ::resource
 {
 
-GLuint load_shader_str(const std::string& vert, const std::string& frag)
+static constexpr std::uint32_t PROGRAM_MAGIC = 0x4752504B;  // "KPRG"
+
+static bool binaries_supported()
 {
-    GLuint vs = compile_shader(GL_VERTEX_SHADER, vert);
-    GLuint fs = compile_shader(GL_FRAGMENT_SHADER, frag);
+    return !program_cache_dir.empty() && glGetProgramBinary && glProgramBinary && glProgramParameteri;
+}
 
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
+// Binaries are only valid for the driver that produced them
+static std::uint64_t program_hash(const std::string& vert, const std::string& frag)
+{
+    std::string key = vert;
+    key += '\0';
+    key += frag;
+    for (GLenum e : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+        key += '\0';
+        if (const GLubyte* str = glGetString(e)) key += reinterpret_cast<const char*>(str);
+    }
+    return pack::hash(key);
+}
 
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+static fs::path binary_path(std::uint64_t hash)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.prog", static_cast<unsigned long long>(hash));
+    return fs::path(program_cache_dir) / name;
+}
+
+static bool load_binary(GLuint program, std::uint64_t hash)
+{
+    std::ifstream in(binary_path(hash), std::ios::binary);
+    if (!in) return false;
+
+    std::uint32_t magic = 0, format = 0, size = 0;
+    std::uint64_t stored = 0;
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char*>(&format), sizeof(format));
+    in.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (!in || magic != PROGRAM_MAGIC || stored != hash) return false;
+
+    std::vector<char> data(size);
+    if (!in.read(data.data(), size)) return false;
+
+    glProgramBinary(program, format, data.data(), static_cast<GLsizei>(size));
+
+    // Drivers reject binaries after an update; fall back to source then
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked;
+}
+
+static void store_binary(GLuint program, std::uint64_t hash)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> data(static_cast<std::size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, data.data());
+
+    std::error_code ec;
+    fs::create_directories(program_cache_dir, ec);
+
+    std::ofstream out(binary_path(hash), std::ios::binary | std::ios::trunc);
+    const std::uint32_t size = static_cast<std::uint32_t>(length);
+    const std::uint32_t fmt = format;
+    out.write(reinterpret_cast<const char*>(&PROGRAM_MAGIC), sizeof(PROGRAM_MAGIC));
+    out.write(reinterpret_cast<const char*>(&fmt), sizeof(fmt));
+    out.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(data.data(), length);
+}
+
+static bool link_ok(GLuint program, std::string* log = nullptr)
+{
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked || !log) return linked;
+
+    char buffer[1024];
+    glGetProgramInfoLog(program, sizeof(buffer), nullptr, buffer);
+    *log = buffer;
+    return false;
+}
+
+Shader build_shader(const std::string& vert, const std::string& frag)
+{
+    Shader shader;
+    shader.program = glCreateProgram();
+
+    const bool binaries = binaries_supported();
+    const std::uint64_t hash = binaries ? program_hash(vert, frag) : 0;
+
+    if (!binaries || !load_binary(shader.program, hash))
+    {
+        GLuint vs = 0;
+        GLuint fs = 0;
+        try
+        {
+            vs = compile_shader(GL_VERTEX_SHADER, vert);
+            fs = compile_shader(GL_FRAGMENT_SHADER, frag);
+        }
+        catch (...)
+        {
+            glDeleteShader(vs);
+            glDeleteProgram(shader.program);
+            throw;
+        }
+
+        if (binaries) glProgramParameteri(shader.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+        glAttachShader(shader.program, vs);
+        glAttachShader(shader.program, fs);
+        glLinkProgram(shader.program);
+
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+
+        std::string log;
+        if (!link_ok(shader.program, &log))
+        {
+            glDeleteProgram(shader.program);
+            throw std::runtime_error(log);
+        }
+
+        if (binaries) store_binary(shader.program, hash);
+    }
+
+    reflect_uniforms(shader);
+    return shader;
+}
+
+void reflect_uniforms(Shader& shader)
+{
+    shader.locations.clear();
+    shader.values.clear();
+
+    GLint count = 0;
+    glGetProgramiv(shader.program, GL_ACTIVE_UNIFORMS, &count);
+
+    for (GLint i = 0; i < count; ++i)
+    {
+        char name[256];
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(shader.program, static_cast<GLuint>(i), sizeof(name), &length, &size, &type, name);
+
+        GLint location = glGetUniformLocation(shader.program, name);
+        if (location < 0) continue;  // Uniform block members
+
+        std::string key(name, static_cast<std::size_t>(length));
+        if (key.ends_with("[0]")) shader.locations[key.substr(0, key.size() - 3)] = location;
+        shader.locations[std::move(key)] = location;
+
+        if (static_cast<std::size_t>(location) + static_cast<std::size_t>(size) > shader.values.size())
+            shader.values.resize(static_cast<std::size_t>(location) + static_cast<std::size_t>(size));
+    }
+}
+
+GLint uniform_location(const Shader& shader, const std::string& name)
+{
+    auto it = shader.locations.find(name);
+    return it == shader.locations.end() ? -1 : it->second;
+}
+
+// Record value for location; false if it matches what was last uploaded
+template <typename T>
+static bool changed(Shader& shader, GLint location, const T& value)
+{
+    if (location < 0) return false;
+
+    if (static_cast<std::size_t>(location) >= shader.values.size()) shader.values.resize(location + 1);
+    UniformValue& cached = shader.values[location];
+
+    if (cached.size == sizeof(T) && std::memcmp(cached.data.data(), &value, sizeof(T)) == 0)
+    {
+        ++shader.skipped;
+        return false;
+    }
+
+    std::memcpy(cached.data.data(), &value, sizeof(T));
+    cached.size = sizeof(T);
+    ++shader.uploads;
+    return true;
+}
+
+void set_uniform(Shader& shader, GLint location, int value)
+{
+    if (changed(shader, location, value)) glUniform1i(location, value);
+}
+
+void set_uniform(Shader& shader, GLint location, float value)
+{
+    if (changed(shader, location, value)) glUniform1f(location, value);
+}
+
+void set_uniform(Shader& shader, GLint location, vec2 value)
+{
+    if (changed(shader, location, value)) glUniform2f(location, value.x, value.y);
+}
+
+void set_uniform(Shader& shader, GLint location, vec4 value)
+{
+    if (changed(shader, location, value)) glUniform4f(location, value.x, value.y, value.z, value.w);
+}
 
-    return program;
+void set_uniform(Shader& shader, GLint location, const mat4& value)
+{
+    if (changed(shader, location, value)) glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
 }
 
-Shader& load_shader(const std::string& name, const std::string& vertex, const std::string& fragment)
+GLuint load_shader_str(const std::string& vert, const std::string& frag) { return build_shader(vert, frag).program; }
+
+ShaderHandle load_shader(const std::string& name, const std::string& vertex, const std::string& fragment)
 {
+    if (ShaderHandle h = shaders.find(name))
+    {
+        shaders.acquire(h);
+        return h;
+    }
+
     LOG_INFO("ShaderManager: Loading shader {}", name);
-    if (shaders.contains(name)) return shaders[name];
 
-    std::string vert_src = read_file(resource::get_path(vertex));
-    std::string frag_src = read_file(resource::get_path(fragment));
+    AssetData vert = read_asset(vertex);
+    AssetData frag = read_asset(fragment);
+    std::string vert_src(reinterpret_cast<const char*>(vert.bytes.data()), vert.bytes.size());
+    std::string frag_src(reinterpret_cast<const char*>(frag.bytes.data()), frag.bytes.size());
+
+    Shader shader = build_shader(vert_src, frag_src);
+
+    shader_sources[name] = {vertex, fragment};
+    return shaders.insert(name, std::move(shader));
+}
+
+ShaderHandle find_shader(const std::string& name) { return shaders.find(name); }
+
+Shader& get_shader(ShaderHandle handle)
+{
+    if (Shader* shader = shaders.get(handle)) return *shader;
 
-    GLuint program = load_shader_str(vert_src, frag_src);
+    LOG_THROW("ShaderManager: Stale shader handle");
+}
+
+Shader& get_shader(const std::string& name)
+{
+    if (Shader* shader = shaders.get(shaders.find(name))) return *shader;
+
+    LOG_THROW("ShaderManager: Shader not found {}", name);
+}
+
+void unload_shader(ShaderHandle handle)
+{
+    Shader* shader = shaders.get(handle);
+    if (!shader || shaders.release(handle) > 0) return;
+
+    glDeleteProgram(shader->program);
+    shader_sources.erase(shaders.name(handle));
+    shaders.erase(handle);
+}
+
+bool reload_shader(const std::string& name)
+{
+    Shader* shader = shaders.get(shaders.find(name));
+    auto src = shader_sources.find(name);
+    if (!shader || src == shader_sources.end()) return false;
+
+    AssetData vert = read_asset(src->second.vertex);
+    AssetData frag = read_asset(src->second.fragment);
+
+    GLuint vs = 0;
+    GLuint fs = 0;
+    try
+    {
+        vs = compile_shader(GL_VERTEX_SHADER, std::string(reinterpret_cast<const char*>(vert.bytes.data()), vert.bytes.size()));
+        fs = compile_shader(GL_FRAGMENT_SHADER, std::string(reinterpret_cast<const char*>(frag.bytes.data()), frag.bytes.size()));
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("ShaderManager: Failed to reload {}: {}", name, e.what());
+        glDeleteShader(vs);
+        return false;
+    }
+
+    // Link into a scratch program first so a broken edit keeps the old program running
+    GLuint scratch = glCreateProgram();
+    glAttachShader(scratch, vs);
+    glAttachShader(scratch, fs);
+    glLinkProgram(scratch);
+
+    GLint linked = 0;
+    glGetProgramiv(scratch, GL_LINK_STATUS, &linked);
+    glDeleteProgram(scratch);
+    if (!linked)
+    {
+        LOG_ERROR("ShaderManager: Failed to link {}", name);
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        return false;
+    }
+
+    // Relink under the same program id so holders of it stay valid
+    GLuint program = shader->program;
+    GLuint attached[8];
+    GLsizei count = 0;
+    glGetAttachedShaders(program, 8, &count, attached);
+    for (GLsizei i = 0; i < count; ++i) glDetachShader(program, attached[i]);
+
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+
+    glDeleteShader(vs);
+    glDeleteShader(fs);
 
-    shaders[name] = {program};
-    return shaders[name];
+    // Locations may have moved, and the driver dropped all uniform values
+    reflect_uniforms(*shader);
+    return true;
 }
 
-Shader& get_shader(const std::string& name) { return shaders.at(name); }
 
 GLuint compile_shader(GLenum type, const std::string& src)
 {
@@ -0,0 +1,206 @@
+#include "kine/resources/texture_cache.hpp"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#include "kine/log.hpp"
+#include "kine/resources/pack.hpp"
+
+namespace fs = std::filesystem;
+
+namespace kine::resource::texture_cache
+{
+
+struct FileHeader
+{
+    std::uint32_t magic = MAGIC;
+    std::uint32_t version = VERSION;
+    std::uint64_t source_hash = 0;
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+    std::int32_t channels = 0;
+    std::uint32_t level_count = 0;
+    std::uint64_t data_size = 0;
+};
+
+static_assert(sizeof(FileHeader) == 40);
+static_assert(sizeof(Level) == 24);
+
+static fs::path entry_path(std::uint64_t hash)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.ktex", static_cast<unsigned long long>(hash));
+    return fs::path(dir) / name;
+}
+
+std::uint64_t source_hash(std::span<const std::byte> bytes)
+{
+    return pack::hash(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+}
+
+CookedTexture cook(const unsigned char* pixels, int width, int height, int channels)
+{
+    CookedTexture tex;
+    tex.width = width;
+    tex.height = height;
+    tex.channels = channels;
+
+    std::uint64_t total = 0;
+    for (int w = width, h = height;; w = std::max(1, w / 2), h = std::max(1, h / 2))
+    {
+        const std::uint64_t size = std::uint64_t(w) * std::uint64_t(h) * std::uint64_t(channels);
+        tex.levels.push_back({total, size, w, h});
+        total += size;
+
+        if (w == 1 && h == 1) break;
+    }
+
+    tex.pixels.resize(total);
+    std::memcpy(tex.pixels.data(), pixels, tex.levels[0].size);
+
+    for (std::size_t i = 1; i < tex.levels.size(); ++i)
+    {
+        const Level& src = tex.levels[i - 1];
+        const Level& dst = tex.levels[i];
+        const auto* in = reinterpret_cast<const unsigned char*>(tex.pixels.data() + src.offset);
+        auto* out = reinterpret_cast<unsigned char*>(tex.pixels.data() + dst.offset);
+
+        for (int y = 0; y < dst.height; ++y)
+        {
+            // Odd edges fold the last row/column onto itself
+            const int y0 = std::min(2 * y, src.height - 1);
+            const int y1 = std::min(2 * y + 1, src.height - 1);
+
+            for (int x = 0; x < dst.width; ++x)
+            {
+                const int x0 = std::min(2 * x, src.width - 1);
+                const int x1 = std::min(2 * x + 1, src.width - 1);
+
+                const unsigned char* a = in + (y0 * src.width + x0) * channels;
+                const unsigned char* b = in + (y0 * src.width + x1) * channels;
+                const unsigned char* c = in + (y1 * src.width + x0) * channels;
+                const unsigned char* d = in + (y1 * src.width + x1) * channels;
+
+                unsigned char* o = out + (y * dst.width + x) * channels;
+                for (int k = 0; k < channels; ++k) o[k] = static_cast<unsigned char>((a[k] + b[k] + c[k] + d[k] + 2) / 4);
+            }
+        }
+    }
+
+    return tex;
+}
+
+// Every level must be exactly the size its mip dimensions say, laid out inside the pixel data
+static bool valid_levels(const CookedTexture& tex)
+{
+    for (std::size_t k = 0; k < tex.levels.size(); ++k)
+    {
+        const Level& l = tex.levels[k];
+        const std::int32_t w = std::max(1, tex.width >> k);
+        const std::int32_t h = std::max(1, tex.height >> k);
+        if (l.width != w || l.height != h || l.size != std::uint64_t(w) * std::uint64_t(h) * std::uint64_t(tex.channels))
+            return false;
+        if (l.offset > tex.pixels.size() || l.size > tex.pixels.size() - l.offset) return false;
+    }
+    return true;
+}
+
+bool load(std::uint64_t hash, CookedTexture& out)
+{
+    if (dir.empty()) return false;
+
+    std::ifstream file(entry_path(hash), std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    const auto file_size = static_cast<std::uint64_t>(file.tellg());
+    file.seekg(0);
+
+    FileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+
+    // A truncated or hand-edited entry is treated as a miss, checked before anything is allocated from it
+    if (header.magic != MAGIC || header.version != VERSION || header.source_hash != hash || header.level_count == 0 ||
+        header.level_count > 32 || header.width <= 0 || header.height <= 0 || header.channels < 1 ||
+        header.channels > 4)
+        return false;
+
+    const std::uint64_t levels_size = std::uint64_t(header.level_count) * sizeof(Level);
+    if (file_size < sizeof(header) + levels_size || header.data_size != file_size - sizeof(header) - levels_size)
+        return false;
+
+    out.width = header.width;
+    out.height = header.height;
+    out.channels = header.channels;
+    out.levels.resize(header.level_count);
+    out.pixels.resize(header.data_size);
+
+    file.read(reinterpret_cast<char*>(out.levels.data()), std::streamsize(levels_size));
+    file.read(reinterpret_cast<char*>(out.pixels.data()), std::streamsize(out.pixels.size()));
+    return file && valid_levels(out);
+}
+
+void store(std::uint64_t hash, const CookedTexture& tex)
+{
+    static std::atomic<bool> warned = false;
+    if (dir.empty()) return;
+
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+
+    // Written under a per-thread name and renamed, so readers never see a partial entry
+    const fs::path path = entry_path(hash);
+    fs::path tmp = path;
+    tmp += '.';
+    tmp += std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    tmp += ".tmp";
+
+    FileHeader header;
+    header.source_hash = hash;
+    header.width = tex.width;
+    header.height = tex.height;
+    header.channels = tex.channels;
+    header.level_count = static_cast<std::uint32_t>(tex.levels.size());
+    header.data_size = tex.pixels.size();
+
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(tex.levels.data()), std::streamsize(tex.levels.size() * sizeof(Level)));
+        file.write(reinterpret_cast<const char*>(tex.pixels.data()), std::streamsize(tex.pixels.size()));
+        ec = file ? std::error_code{} : std::make_error_code(std::errc::io_error);
+    }
+
+    if (!ec) fs::rename(tmp, path, ec);
+    if (ec)
+    {
+        fs::remove(tmp, ec);
+        if (!warned.exchange(true)) LOG_WARN("TextureCache: Failed to write to {}", dir);
+    }
+}
+
+bool decode(std::span<const std::byte> bytes, CookedTexture& out)
+{
+    const std::uint64_t hash = enabled ? source_hash(bytes) : 0;
+    if (enabled && load(hash, out)) return true;
+
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load_thread(true);
+    unsigned char* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(bytes.data()),
+                                                  static_cast<int>(bytes.size()), &width, &height, &channels, 0);
+    if (!pixels) return false;
+
+    out = cook(pixels, width, height, channels);
+    stbi_image_free(pixels);
+
+    if (enabled) store(hash, out);
+    return true;
+}
+
+}  // namespace kine::resource::texture_cache
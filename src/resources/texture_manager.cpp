@@ -1,114 +1,209 @@
 #include "kine/resources/resource_manager.hpp"
 
-#include <stb_image.h>
+#include <fstream>
 
 namespace kine::resource
 {
 
-Texture2D& load_texture(const std::string& name, const std::string& file)
+TextureHandle load_texture(const std::string& name, const std::string& file)
 {
+    if (TextureHandle h = textures.find(name))
+    {
+        textures.acquire(h);
+        return h;
+    }
+
     LOG_INFO("TextureManager: Loading texture {}", name);
 
-    if (textures.contains(name)) return textures[name];
+    AssetData data = read_asset(file);
+    Texture2D tex = load_texture_memory(name, data.bytes);
+    if (!tex.id) return error_handle;
 
-    const std::string& path = resource::get_path(file);
-    textures[name] = load_texture_file(name, path);
-    return textures[name];
+    texture_sources[name] = file;
+    return textures.insert(name, std::move(tex));
 }
 
-Texture2D& get_texture(const std::string& name)
+bool reload_texture(const std::string& name)
 {
-    if (textures.contains(name)) return textures.at(name);
+    Texture2D* tex = textures.get(textures.find(name));
+    auto src = texture_sources.find(name);
+    if (!tex || src == texture_sources.end() || !tex->ready) return false;
 
-    LOG_ERROR("TextureManager: Failed to load texture {}", name);
-    return *error_texture;
+    AssetData data = read_asset(src->second);
+
+    texture_cache::CookedTexture cooked;
+    if (!texture_cache::decode(data.bytes, cooked))
+    {
+        LOG_ERROR("TextureManager: Failed to reload texture {}", src->second);
+        return false;
+    }
+
+    upload_cooked(*tex, cooked);
+    return true;
 }
 
-Texture2D& add_texture(const std::string& name, Texture2D&& tex) { return textures[name] = std::move(tex); }
+TextureHandle find_texture(const std::string& name) { return textures.find(name); }
 
-Texture2D& load_embedded_texture(const std::string& name, const unsigned char* data, const unsigned int len)
+Texture2D& peek_texture(TextureHandle handle)
 {
-    if (textures.contains(name)) return textures[name];
-
-    Texture2D tex;
-    tex.name = name;
+    Texture2D* tex = textures.get(handle);
+    return tex ? *tex : *error_texture;
+}
 
-    int channels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* image = stbi_load_from_memory(data, len, &tex.width, &tex.height, &channels, 0);
+Texture2D& get_texture(TextureHandle handle)
+{
+    Texture2D& tex = peek_texture(handle);
+    tex.pinned = true;
+    return tex;
+}
 
-    if (!image)
+Texture2D& get_texture(const std::string& name)
+{
+    if (Texture2D* tex = textures.get(textures.find(name)))
     {
-        LOG_ERROR("TextureManager: Failed to load texture from memory {}", name);
-        return *error_texture;
+        tex->pinned = true;
+        return *tex;
     }
 
-    GLenum format = GL_RGB;
-    if (channels == 1)
-        format = GL_RED;
-    else if (channels == 3)
-        format = GL_RGB;
-    else if (channels == 4)
-        format = GL_RGBA;
+    LOG_ERROR("TextureManager: Failed to load texture {}", name);
+    return *error_texture;
+}
 
-    glGenTextures(1, &tex.id);
-    glBindTexture(GL_TEXTURE_2D, tex.id);
+TextureHandle add_texture(const std::string& name, Texture2D&& tex)
+{
+    if (TextureHandle h = textures.find(name)) destroy_texture(h);
+    return textures.insert(name, std::move(tex));
+}
 
-    glTexImage2D(GL_TEXTURE_2D, 0, format, tex.width, tex.height, 0, format, GL_UNSIGNED_BYTE, image);
+TextureHandle load_embedded_texture(const std::string& name, const unsigned char* data, const unsigned int len)
+{
+    if (TextureHandle h = textures.find(name))
+    {
+        textures.acquire(h);
+        return h;
+    }
 
-    glGenerateMipmap(GL_TEXTURE_2D);
+    Texture2D tex = load_texture_memory(name, std::as_bytes(std::span(data, len)));
+    if (!tex.id) return error_handle;
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return textures.insert(name, std::move(tex));
+}
 
-    stbi_image_free(image);
-    glBindTexture(GL_TEXTURE_2D, 0);
+void unload_texture(TextureHandle handle)
+{
+    if (handle == error_handle || !textures.contains(handle)) return;
+    if (textures.release(handle) == 0) destroy_texture(handle);
+}
 
-    textures[name] = tex;
-    return textures[name];
+void destroy_texture(TextureHandle handle)
+{
+    Texture2D* tex = textures.get(handle);
+    if (!tex || handle == error_handle) return;
+
+    // Textures still loading only borrow the error texture's id
+    if (tex->id && tex->ready) glDeleteTextures(1, &tex->id);
+    residency::account(*tex, 0);
+
+    texture_sources.erase(textures.name(handle));
+    textures.erase(handle);
 }
 
-Texture2D load_texture_file(const std::string& name, const std::string& path)
+Texture2D load_texture_memory(const std::string& name, std::span<const std::byte> bytes)
 {
     Texture2D tex;
     tex.name = name;
 
-    int channels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(path.c_str(), &tex.width, &tex.height, &channels, 0);
+    texture_cache::CookedTexture cooked;
+    if (!texture_cache::decode(bytes, cooked))
+    {
+        LOG_ERROR("TextureManager: Failed to load texture from memory {}", name);
+        return tex;
+    }
+
+    upload_cooked(tex, cooked);
+    return tex;
+}
 
-    if (!data)
+Texture2D load_texture_file(const std::string& name, const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
     {
         LOG_ERROR("TextureManager: Failed to load texture {}", path);
         return *error_texture;
     }
 
-    GLenum format = GL_RGB;
-    if (channels == 1)
-        format = GL_RED;
-    else if (channels == 3)
-        format = GL_RGB;
-    else if (channels == 4)
-        format = GL_RGBA;
+    std::vector<std::byte> data(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()));
 
-    glGenTextures(1, &tex.id);
-    glBindTexture(GL_TEXTURE_2D, tex.id);
+    Texture2D tex = load_texture_memory(name, data);
+    return tex.id ? tex : *error_texture;
+}
 
-    glTexImage2D(GL_TEXTURE_2D, 0, format, tex.width, tex.height, 0, format, GL_UNSIGNED_BYTE, data);
+// Drivers commonly pad RGB8 to 4 bytes per texel
+static std::size_t texel_bytes(int channels) { return channels == 1 ? 1 : 4; }
 
-    glGenerateMipmap(GL_TEXTURE_2D);
+static GLenum channel_format(int channels)
+{
+    if (channels == 1) return GL_RED;
+    if (channels == 4) return GL_RGBA;
+    return GL_RGB;
+}
 
+static void set_sampling()
+{
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+void upload_texture(Texture2D& tex, const unsigned char* pixels, int channels)
+{
+    GLenum format = channel_format(channels);
+
+    if (!tex.id) glGenTextures(1, &tex.id);
+    glBindTexture(GL_TEXTURE_2D, tex.id);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, tex.width, tex.height, 0, format, GL_UNSIGNED_BYTE, pixels);
+
+    glGenerateMipmap(GL_TEXTURE_2D);
+    set_sampling();
+
+    // Full chain is ~4/3 of the base level
+    residency::account(tex, std::size_t(tex.width) * std::size_t(tex.height) * texel_bytes(channels) * 4 / 3);
 
-    stbi_image_free(data);
     glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-    return tex;
+void upload_cooked(Texture2D& tex, const texture_cache::CookedTexture& cooked)
+{
+    GLenum format = channel_format(cooked.channels);
+    tex.width = cooked.width;
+    tex.height = cooked.height;
+
+    if (!tex.id) glGenTextures(1, &tex.id);
+    glBindTexture(GL_TEXTURE_2D, tex.id);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (std::size_t i = 0; i < cooked.levels.size(); ++i)
+    {
+        const texture_cache::Level& level = cooked.levels[i];
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), format, level.width, level.height, 0, format,
+                     GL_UNSIGNED_BYTE, cooked.pixels.data() + level.offset);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(cooked.levels.size() - 1));
+    set_sampling();
+
+    std::size_t bytes = 0;
+    for (const texture_cache::Level& level : cooked.levels)
+        bytes += std::size_t(level.width) * std::size_t(level.height) * texel_bytes(cooked.channels);
+    residency::account(tex, bytes);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 }  // namespace kine::resource
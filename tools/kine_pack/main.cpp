@@ -0,0 +1,59 @@
+// Packs asset directories into a single .kpak archive.
+//
+//   kine_pack <out.kpak> <dir> [dir...]
+//
+// Entries are keyed by their path relative to the directory they were found
+// in, matching resource::file_index. Files ending in ".br" are stored as
+// brotli entries under the name without the suffix.
+
+#include <filesystem>
+
+#include "kine/log.hpp"
+#include "kine/resources/pack.hpp"
+
+namespace fs = std::filesystem;
+using namespace kine;
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        LOG_ERROR("usage: {} <out.kpak> <dir> [dir...]", argv[0]);
+        return 1;
+    }
+
+    std::vector<pack::Source> sources;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        fs::path root = argv[i];
+        if (!fs::is_directory(root))
+        {
+            LOG_ERROR("kine_pack: {} is not a directory", root.string());
+            return 1;
+        }
+
+        for (const auto& entry : fs::recursive_directory_iterator(root))
+        {
+            if (!entry.is_regular_file()) continue;
+
+            pack::Source src;
+            src.path = entry.path().string();
+            src.name = entry.path().lexically_relative(root).generic_string();
+
+            if (entry.path().extension() == ".br")
+            {
+                src.name.resize(src.name.size() - 3);
+                src.compression = pack::Compression::Brotli;
+            }
+
+            sources.push_back(std::move(src));
+        }
+    }
+
+    const std::size_t count = sources.size();
+    if (!pack::write(argv[1], std::move(sources))) return 1;
+
+    LOG_INFO("kine_pack: Wrote {} entries to {}", count, argv[1]);
+    return 0;
+}